@@ -1,14 +1,203 @@
 #pragma once
 
 #include <gpiod.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
+
+#include "bsp_thread.hpp"
+
+/**
+ * GpioEventLoop class
+ *
+ * One thread waits in poll() on the event fds of every GPIO line with an
+ * interrupt, instead of one blocking waiter thread per line. Handlers run
+ * on that thread, one at a time, without the loop lock held, so they may
+ * add or remove lines. Remove() waits for a running handler of its fd, so
+ * a line can be released right after.
+ */
+class GpioEventLoop {
+ public:
+  using Handler = std::function<void()>;
+
+  /**
+   * Starts the loop thread.
+   *
+   * @param role Placement of the loop thread; a line that needs realtime
+   *             handling gets a private loop with e.g. Role::IMU
+   */
+  explicit GpioEventLoop(
+      ThreadConfig::Role role = ThreadConfig::Role::GPIO_EVENTS)
+      : role_(role), wake_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    if (wake_fd_ < 0) {
+      std::perror("Failed to create GPIO event loop");
+      return;
+    }
+    thread_ = std::thread(&GpioEventLoop::Loop, this);
+  }
+
+  ~GpioEventLoop() {
+    running_ = false;
+    Wake();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    if (wake_fd_ >= 0) {
+      close(wake_fd_);
+    }
+  }
+
+  GpioEventLoop(const GpioEventLoop&) = delete;
+  GpioEventLoop& operator=(const GpioEventLoop&) = delete;
+
+  /** Process-wide loop shared by every Gpio */
+  static GpioEventLoop& Default() {
+    static GpioEventLoop loop;
+    return loop;
+  }
+
+  /**
+   * Calls `handler` whenever `fd` becomes readable.
+   *
+   * @param fd      File descriptor to watch
+   * @param handler Called on the loop thread
+   */
+  void Add(int fd, Handler handler) {
+    auto entry = std::make_shared<Entry>(fd, std::move(handler));
+    std::lock_guard<std::mutex> lock(mutex_);
+    handlers_.push_back(std::move(entry));
+    changed_ = true;
+    Wake();
+  }
+
+  /**
+   * Stops watching `fd`; returns once its handler is not running, unless
+   * called from a handler on the loop thread.
+   *
+   * @param fd File descriptor passed to Add()
+   */
+  void Remove(int fd) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::find_if(handlers_.begin(), handlers_.end(),
+                           [fd](const auto& entry) { return entry->fd == fd; });
+    if (it == handlers_.end()) {
+      return;
+    }
+    std::shared_ptr<Entry> entry = std::move(*it);
+    handlers_.erase(it);
+    changed_ = true;
+    Wake();
+
+    if (std::this_thread::get_id() != thread_.get_id()) {
+      idle_.wait(lock, [&entry]() { return entry->in_flight == 0; });
+    }
+  }
+
+ private:
+  void Wake() {
+    if (wake_fd_ >= 0) {
+      uint64_t one = 1;
+      (void)(write(wake_fd_, &one, sizeof(one)));
+    }
+  }
+
+  /**
+   * Loop thread: rebuilds the poll set after Add()/Remove() and dispatches
+   * every readable fd.
+   */
+  void Loop() {
+    ThreadConfig::Apply(role_);
+
+    std::vector<pollfd> fds;
+    while (running_) {
+      if (changed_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fds.assign(1, pollfd{wake_fd_, POLLIN, 0});
+        for (const auto& entry : handlers_) {
+          fds.push_back(pollfd{entry->fd, POLLIN | POLLPRI, 0});
+        }
+      }
+
+      if (poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        std::perror("GPIO poll failed");
+        break;
+      }
+
+      if (fds[0].revents & POLLIN) {
+        uint64_t count;
+        (void)(read(wake_fd_, &count, sizeof(count)));
+      }
+
+      for (size_t i = 1; i < fds.size(); ++i) {
+        if (!(fds[i].revents & (POLLIN | POLLPRI))) {
+          continue;
+        }
+        /* The fd may have been removed since the poll set was built */
+        std::shared_ptr<Entry> entry;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          for (const auto& candidate : handlers_) {
+            if (candidate->fd == fds[i].fd) {
+              entry = candidate;
+              entry->in_flight++;
+              break;
+            }
+          }
+        }
+        if (!entry) {
+          continue;
+        }
+
+        entry->handler();
+
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          entry->in_flight--;
+        }
+        idle_.notify_all();
+      }
+    }
+  }
+
+  /* One watched fd; shared with a dispatch in progress so Remove() can
+   * drop it from the list while the handler still runs */
+  struct Entry {
+    Entry(int entry_fd, Handler entry_handler)
+        : fd(entry_fd), handler(std::move(entry_handler)) {}
+
+    int fd;
+    Handler handler;
+    int in_flight = 0; /* Running dispatches, guarded by mutex_ */
+  };
+
+  ThreadConfig::Role role_;       /* Placement of the loop thread */
+  int wake_fd_;                   /* Wakes poll() on Add/Remove/exit */
+  std::atomic<bool> running_{true};
+  std::atomic<bool> changed_{true}; /* Poll set needs a rebuild */
+  std::mutex mutex_;                /* Guards handlers_ and in_flight */
+  std::condition_variable idle_;    /* Signalled when a dispatch ends */
+  std::vector<std::shared_ptr<Entry>> handlers_;
+  std::thread thread_;
+};
 
 /**
  * Gpio class
@@ -56,14 +245,10 @@ class Gpio {
   /**
    * Destructor
    *
-   * Releases allocated resources and stops interrupt thread.
+   * Releases allocated resources and stops interrupt delivery.
    */
   ~Gpio() {
-    running_ = false;
-
-    if (interrupt_thread_.joinable()) {
-      interrupt_thread_.join();
-    }
+    DisableInterrupt();
 
     if (line_) {
       gpiod_line_release(line_);
@@ -102,11 +287,15 @@ class Gpio {
   /**
    * Enable rising edge interrupt and register callback.
    *
-   * This starts a background thread to monitor GPIO events.
+   * The line is watched by the shared GpioEventLoop thread unless another
+   * loop is given; that loop must outlive the interrupt, see
+   * DisableInterrupt().
    *
-   * @param cb Callback function to be invoked on rising edge.
+   * @param cb   Callback function to be invoked on rising edge.
+   * @param loop Event loop running the callback
    */
-  void EnableInterruptRisingEdgeWithCallback(Callback cb) {
+  void EnableInterruptRisingEdgeWithCallback(
+      Callback cb, GpioEventLoop& loop = GpioEventLoop::Default()) {
     if (is_output_) {
       std::perror("Cannot register interrupt on output GPIO");
     }
@@ -122,25 +311,35 @@ class Gpio {
     }
 
     callback_ = std::move(cb);
-    running_ = true;
 
-    interrupt_thread_ = std::thread(&Gpio::InterruptWaitLoop, this);
+    event_fd_ = gpiod_line_event_get_fd(line_);
+    if (event_fd_ < 0) {
+      std::perror("Failed to get GPIO event fd");
+      return;
+    }
+    loop_ = &loop;
+    loop_->Add(event_fd_, [this]() { OnEvent(); });
+  }
+
+  /**
+   * Stop delivering edge events; returns once the callback is not running.
+   */
+  void DisableInterrupt() {
+    if (loop_) {
+      loop_->Remove(event_fd_);
+      loop_ = nullptr;
+    }
   }
 
  private:
   /**
-   * Background thread loop that waits for GPIO rising edge events.
+   * Reads one pending edge event, on the event loop thread.
    */
-  void InterruptWaitLoop() {
-    while (running_) {
-      int ret = gpiod_line_event_wait(line_, nullptr);  // block until event
-      if (ret == 1 && callback_) {
-        struct gpiod_line_event event;
-        if (gpiod_line_event_read(line_, &event) == 0 &&
-            event.event_type == GPIOD_LINE_EVENT_RISING_EDGE) {
-          callback_();
-        }
-      }
+  void OnEvent() {
+    struct gpiod_line_event event;
+    if (gpiod_line_event_read(line_, &event) == 0 &&
+        event.event_type == GPIOD_LINE_EVENT_RISING_EDGE && callback_) {
+      callback_();
     }
   }
 
@@ -149,7 +348,7 @@ class Gpio {
   unsigned int line_num_;  // Line number
   bool is_output_;         // Output mode flag
 
-  std::atomic<bool> running_{false};  // Interrupt thread flag
-  std::thread interrupt_thread_;      // Interrupt handler thread
-  Callback callback_;                 // Registered callback
+  int event_fd_ = -1;              // Edge event fd watched by the loop
+  GpioEventLoop* loop_ = nullptr;  // Loop watching event_fd_, if any
+  Callback callback_;              // Registered callback
 };
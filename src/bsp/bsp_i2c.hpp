@@ -2,48 +2,134 @@
 
 #include <fcntl.h>
 #include <linux/i2c-dev.h>
+#include <linux/i2c.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 /**
- * I2C device interface for configuration and register operations.
+ * I2C bus shared by every device on one adapter.
+ *
+ * Owns a single file descriptor per bus and addresses each message through
+ * the I2C_RDWR ioctl, so devices never have to switch the fd with
+ * I2C_SLAVE. A register read is one combined write-then-read transaction
+ * with a repeated start. Transactions from different threads are
+ * serialized by the bus.
  */
-class I2cDevice {
+class I2cBus {
  public:
   /**
-   * Opens and configures the I2C device.
+   * Opens the I2C adapter.
    *
    * @param device I2C device file path (e.g., "/dev/i2c-1")
-   * @param addr   7-bit I2C device address
    */
-  I2cDevice(const std::string& device, uint8_t addr)
-      : fd_(open(device.c_str(), O_RDWR)), addr_(addr) {
+  explicit I2cBus(const std::string& device)
+      : fd_(open(device.c_str(), O_RDWR | O_CLOEXEC)) {
     assert(!device.empty()); /* Ensure device string is valid */
 
     if (fd_ < 0) {
-      std::perror("Failed to open I2C device");
+      std::perror("Failed to open I2C bus");
     }
+  }
 
-    if (ioctl(fd_, I2C_SLAVE, addr_) < 0) {
+  /** Closes the I2C adapter. */
+  ~I2cBus() {
+    if (fd_ >= 0) {
       close(fd_);
-      std::perror("Failed to configure I2C address");
     }
   }
 
-  /** Closes the I2C device. */
-  ~I2cDevice() {
-    if (fd_ >= 0) {
-      close(fd_);
+  I2cBus(const I2cBus&) = delete;
+  I2cBus& operator=(const I2cBus&) = delete;
+
+  /**
+   * Writes raw bytes to a device in one transaction.
+   *
+   * @param addr   7-bit I2C device address
+   * @param data   Bytes to write, register address first if any
+   * @param length Number of bytes to write
+   * @return true on success
+   */
+  bool Write(uint8_t addr, const uint8_t* data, size_t length) {
+    i2c_msg msg = {addr, 0, static_cast<uint16_t>(length),
+                   const_cast<uint8_t*>(data)};
+    return Transfer(&msg, 1);
+  }
+
+  /**
+   * Reads a register block: writes the register address and reads the
+   * data after a repeated start, in one ioctl.
+   *
+   * @param addr   7-bit I2C device address
+   * @param reg    Starting register address
+   * @param buffer Destination buffer
+   * @param length Number of bytes to read
+   * @return true on success
+   */
+  bool Read(uint8_t addr, uint8_t reg, uint8_t* buffer, size_t length) {
+    assert(buffer);
+    std::array<i2c_msg, 2> msgs = {{
+        {addr, 0, 1, &reg},
+        {addr, I2C_M_RD, static_cast<uint16_t>(length), buffer},
+    }};
+    return Transfer(msgs.data(), msgs.size());
+  }
+
+  /**
+   * Reads bytes from a device without writing a register address first.
+   *
+   * @param addr   7-bit I2C device address
+   * @param buffer Destination buffer
+   * @param length Number of bytes to read
+   * @return true on success
+   */
+  bool ReadRaw(uint8_t addr, uint8_t* buffer, size_t length) {
+    i2c_msg msg = {addr, I2C_M_RD, static_cast<uint16_t>(length), buffer};
+    return Transfer(&msg, 1);
+  }
+
+  /**
+   * Returns the underlying file descriptor.
+   */
+  int Fd() const { return fd_; }
+
+ private:
+  bool Transfer(i2c_msg* msgs, size_t count) {
+    i2c_rdwr_ioctl_data data = {msgs, static_cast<uint32_t>(count)};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ioctl(fd_, I2C_RDWR, &data) != static_cast<int>(count)) {
+      std::perror("I2C transfer failed");
+      return false;
     }
+    return true;
   }
 
+  int fd_;           /* I2C adapter file descriptor */
+  std::mutex mutex_; /* Serializes transactions across devices */
+};
+
+/**
+ * I2C device interface for configuration and register operations.
+ */
+class I2cDevice {
+ public:
+  /**
+   * Attaches a device to a shared bus.
+   *
+   * @param bus  Bus the device is connected to
+   * @param addr 7-bit I2C device address
+   */
+  I2cDevice(I2cBus& bus, uint8_t addr) : bus_(bus), addr_(addr) {}
+
   /**
    * Reads a single byte from an I2C register.
    *
@@ -51,15 +137,8 @@ class I2cDevice {
    * @return Value read
    */
   uint8_t ReadRegister(uint8_t reg) {
-    if (write(fd_, &reg, 1) != 1) {
-      std::perror("I2C write (set register) failed");
-    }
-
     uint8_t value = 0;
-    if (read(fd_, &value, 1) != 1) {
-      std::perror("I2C read failed");
-    }
-
+    bus_.Read(addr_, reg, &value, 1);
     return value;
   }
 
@@ -71,9 +150,7 @@ class I2cDevice {
    */
   void WriteRegister(uint8_t reg, uint8_t value) {
     uint8_t buf[2] = {reg, value};
-    if (write(fd_, buf, 2) != 2) {
-      std::perror("I2C write failed");
-    }
+    bus_.Write(addr_, buf, 2);
   }
 
   /**
@@ -85,14 +162,7 @@ class I2cDevice {
    */
   void ReadRegisters(uint8_t reg, uint8_t* buffer, size_t length) {
     assert(buffer);
-
-    if (write(fd_, &reg, 1) != 1) {
-      std::perror("I2C write (set start register) failed");
-    }
-
-    if (read(fd_, buffer, length) != static_cast<ssize_t>(length)) {
-      std::perror("I2C multi-byte read failed");
-    }
+    bus_.Read(addr_, reg, buffer, length);
   }
 
   /**
@@ -103,16 +173,24 @@ class I2cDevice {
    */
   void WriteRaw(const uint8_t* data, size_t length) {
     assert(data);
+    bus_.Write(addr_, data, length);
+  }
 
-    if (write(fd_, data, length) != static_cast<ssize_t>(length)) {
-      std::perror("I2C raw write failed");
-    }
+  /**
+   * Reads raw bytes directly from the I2C device without a register prefix.
+   *
+   * @param buffer Destination buffer
+   * @param length Number of bytes to read
+   */
+  void ReadRaw(uint8_t* buffer, size_t length) {
+    assert(buffer);
+    bus_.ReadRaw(addr_, buffer, length);
   }
 
   /**
-   * Returns the underlying file descriptor.
+   * Returns the file descriptor of the bus.
    */
-  int Fd() const { return fd_; }
+  int Fd() const { return bus_.Fd(); }
 
   /**
    * Returns the I2C slave address.
@@ -120,6 +198,6 @@ class I2cDevice {
   uint8_t Address() const { return addr_; }
 
  private:
-  int fd_;       /* I2C file descriptor */
+  I2cBus& bus_;  /* Shared bus */
   uint8_t addr_; /* I2C device address */
 };
@@ -9,6 +9,8 @@
 #include <string>
 #include <thread>
 
+#include "bsp_thread.hpp"
+
 /**
  * @brief PWM driver with Beep and PlayNote functionality.
  *
@@ -56,6 +58,7 @@ class PWM {
 
     // Launch background thread to play notes asynchronously.
     note_thread_ = std::thread([this]() {
+      ThreadConfig::Apply(ThreadConfig::Role::BUZZER);
       while (true) {
         note_sem_.acquire();
         float midi = static_cast<float>(note_) +
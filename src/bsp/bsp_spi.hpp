@@ -9,6 +9,7 @@
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <span>
 #include <stdexcept>
 #include <string>
 
@@ -104,30 +105,92 @@ class SpiDevice {
     cs->Write(1);
   }
 
+  /**
+   * Burst-reads consecutive registers via SPI.
+   *
+   * The address byte and the data phase are two transfers of one message,
+   * so data lands directly in `buffer` without heap or bounce buffers.
+   *
+   * @param cs     GPIO chip select (active low)
+   * @param reg    First register address
+   * @param buffer Destination for `length` bytes
+   * @param length Number of bytes to read
+   */
   void ReadRegisters(Gpio* cs, uint8_t reg, uint8_t* buffer, size_t length) {
     assert(cs);
     assert(buffer);
 
-    std::vector<uint8_t> tx_buf(length + 1, 0);
-    std::vector<uint8_t> rx_buf(length + 1, 0);
-    tx_buf[0] = reg | 0x80;
+    uint8_t address = reg | 0x80;
 
-    struct spi_ioc_transfer transfer{};
-    transfer.tx_buf = reinterpret_cast<uint64_t>(tx_buf.data());
-    transfer.rx_buf = reinterpret_cast<uint64_t>(rx_buf.data());
-    transfer.len = tx_buf.size();
-    transfer.speed_hz = speed_;
-    transfer.bits_per_word = 8;
+    std::array<spi_ioc_transfer, 2> transfers{};
+    transfers[0].tx_buf = reinterpret_cast<uint64_t>(&address);
+    transfers[0].len = 1;
+    transfers[0].speed_hz = speed_;
+    transfers[0].bits_per_word = 8;
+
+    /* tx_buf == 0 clocks out zeros while reading */
+    transfers[1].rx_buf = reinterpret_cast<uint64_t>(buffer);
+    transfers[1].len = static_cast<uint32_t>(length);
+    transfers[1].speed_hz = speed_;
+    transfers[1].bits_per_word = 8;
 
     cs->Write(0);
     usleep(10);
-    if (ioctl(fd_, SPI_IOC_MESSAGE(1), &transfer) < 0) {
+    if (ioctl(fd_, SPI_IOC_MESSAGE(2), transfers.data()) < 0) {
       cs->Write(1);
       std::perror("SPI multiple read failed");
     }
     cs->Write(1);
+  }
+
+  /**
+   * Burst-reads consecutive registers into a caller-owned buffer.
+   *
+   * @param cs     GPIO chip select (active low)
+   * @param reg    First register address
+   * @param buffer Destination, its size is the read length
+   */
+  void ReadRegisters(Gpio* cs, uint8_t reg, std::span<uint8_t> buffer) {
+    ReadRegisters(cs, reg, buffer.data(), buffer.size());
+  }
+
+  /**
+   * Burst-reads N consecutive registers into a stack buffer.
+   *
+   * @tparam N  Number of bytes to read
+   * @param cs  GPIO chip select (active low)
+   * @param reg First register address
+   * @return Register contents
+   */
+  template <size_t N>
+  std::array<uint8_t, N> ReadRegisters(Gpio* cs, uint8_t reg) {
+    std::array<uint8_t, N> data{};
+    ReadRegisters(cs, reg, data.data(), N);
+    return data;
+  }
 
-    std::memcpy(buffer, rx_buf.data() + 1, length);
+  /**
+   * Submits several transfers as one SPI_IOC_MESSAGE(N) ioctl.
+   *
+   * Chip select is driven by the kernel for this path. Set `cs_change` on a
+   * transfer to release CS after it, e.g. to latch one command per transfer.
+   *
+   * @param transfers Transfer descriptors
+   * @param count     Number of transfers
+   * @return true on success
+   */
+  bool TransferBatch(spi_ioc_transfer* transfers, size_t count) {
+    assert(transfers);
+
+    if (count == 0) {
+      return true;
+    }
+
+    if (ioctl(fd_, SPI_IOC_MESSAGE(count), transfers) < 0) {
+      std::perror("SPI batch transfer failed");
+      return false;
+    }
+    return true;
   }
 
   int Fd() const { return fd_; }
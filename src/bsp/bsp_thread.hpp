@@ -0,0 +1,122 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * Thread topology of the process.
+ *
+ * Every long-lived thread calls Apply() with its role when it starts. The
+ * table below names the thread and decides where it runs: the IMU
+ * acquisition and AHRS fusion threads get the last CPU to themselves under
+ * SCHED_FIFO, everything else shares the remaining "general" CPUs. The main
+ * thread calls ReserveRealtimeCore() first thing, so threads started by
+ * libraries (e.g. the ONNX Runtime pool) inherit the general set too.
+ *
+ * SCHED_FIFO needs CAP_SYS_NICE or an RLIMIT_RTPRIO (LimitRTPRIO= in the
+ * service unit); without it the thread keeps its name and affinity and a
+ * warning is printed.
+ */
+class ThreadConfig {
+ public:
+  /** Long-lived threads of the process */
+  enum class Role : uint8_t {
+    MAIN,        /* Main loop and rendering */
+    GPIO_EVENTS, /* Shared GPIO edge poll loop */
+    IMU,         /* MPU9250 FIFO drain or data-ready loop */
+    AHRS,        /* Madgwick fusion */
+    INFERENCE,   /* Gesture model */
+    RECORDER,    /* Dataset writer */
+    BUZZER,      /* PWM note player */
+    NUMBER
+  };
+
+  /** Placement of one role */
+  struct Spec {
+    const char* name;    /* pthread name, at most 15 characters */
+    int rt_priority;     /* SCHED_FIFO priority, 0 for SCHED_OTHER */
+    bool realtime_core;  /* Pin to the reserved core instead of the rest */
+  };
+
+  static constexpr std::array<Spec, static_cast<size_t>(Role::NUMBER)> SPECS =
+      {{
+          {"fluxsand", 0, false},
+          {"gpio-events", 0, false},
+          {"imu", 80, true},
+          {"ahrs", 70, true},
+          {"inference", 0, false},
+          {"recorder", 0, false},
+          {"buzzer", 0, false},
+      }};
+
+  /**
+   * Reserves the last CPU for the realtime roles by moving the calling
+   * thread, and everything it starts from now on, to the other CPUs.
+   */
+  static void ReserveRealtimeCore() { Apply(Role::MAIN); }
+
+  /**
+   * Names the calling thread and applies the affinity and scheduling of
+   * its role.
+   *
+   * @param role Role of the calling thread
+   * @return false if any setting could not be applied
+   */
+  static bool Apply(Role role) {
+    const Spec& spec = SPECS[static_cast<size_t>(role)];
+    bool ok = pthread_setname_np(pthread_self(), spec.name) == 0;
+
+    cpu_set_t cpus = spec.realtime_core ? RealtimeCpus() : GeneralCpus();
+    ok &= pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+
+    if (spec.rt_priority > 0) {
+      sched_param param{};
+      param.sched_priority = spec.rt_priority;
+      int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      if (ret != 0) {
+        std::fprintf(stderr, "Thread %s: SCHED_FIFO %d not permitted: %s\n",
+                     spec.name, spec.rt_priority, std::strerror(ret));
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  /** Number of CPUs left for the non-realtime threads */
+  static int GeneralCoreCount() {
+    cpu_set_t cpus = GeneralCpus();
+    return CPU_COUNT(&cpus);
+  }
+
+ private:
+  static int OnlineCpus() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<int>(count) : 1;
+  }
+
+  /* The last CPU, or the only one */
+  static cpu_set_t RealtimeCpus() {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(OnlineCpus() - 1, &cpus);
+    return cpus;
+  }
+
+  /* Every CPU but the realtime one, unless there is just one */
+  static cpu_set_t GeneralCpus() {
+    const int COUNT = OnlineCpus();
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu = 0; cpu < (COUNT > 1 ? COUNT - 1 : 1); ++cpu) {
+      CPU_SET(cpu, &cpus);
+    }
+    return cpus;
+  }
+};
@@ -4,54 +4,147 @@
   MadgwickAHRS
 */
 
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <functional>
-#include <semaphore>
+#include <span>
+#include <string>
+#include <vector>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include "bsp.hpp"
+#include "bsp_thread.hpp"
+#include "comp_metrics.hpp"
+#include "comp_recorder.hpp"
+#include "comp_ring_buffer.hpp"
 #include "comp_type.hpp"
 
 class AHRS {
  public:
-  AHRS() : ready_(0) {
+  /** How the integration step is chosen */
+  enum class TimeMode : uint8_t {
+    FIXED,   /* Always NOMINAL_DT */
+    MEASURED /* Difference of consecutive sample timestamps */
+  };
+
+  explicit AHRS(TimeMode time_mode = TimeMode::MEASURED)
+      : time_mode_(time_mode) {
     quat_.q0 = -1.0f;
     quat_.q1 = 0.0f;
     quat_.q2 = 0.0f;
     quat_.q3 = 0.0f;
 
-    start_ = now_ = last_wakeup_ =
-        std::chrono::duration_cast<std::chrono::microseconds>(
-            std::chrono::system_clock::now().time_since_epoch());
+    start_ = now_ = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
 
     thread_ = std::thread(&AHRS::ThreadTask, this);
   }
 
+  /* Per-sample input, timestamped on arrival */
   void OnData(const Type::Vector3& accel, const Type::Vector3& gyro) {
-    accel_ = accel;
-    gyro_ = gyro;
-    ready_.release();
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+    input_.Push(Type::ImuSample{accel, gyro,
+                                static_cast<uint64_t>(now.count())});
+  }
+
+  /* Batch input, e.g. a drained IMU FIFO */
+  void OnSamples(std::span<const Type::ImuSample> samples) {
+    input_.Push(samples);
   }
 
   void ThreadTask() {
+    ThreadConfig::Apply(ThreadConfig::Role::AHRS);
     while (true) {
-      ready_.acquire();
-      Update();
+      input_.Wait();
+
+      /* Fuse every queued sample in order, none are skipped */
+      size_t count;
+      while ((count = input_.Pop(batch_.data(), batch_.size())) > 0) {
+        ScopedLatency latency(Metrics::Stage::AHRS_UPDATE);
+        Update(std::span<const Type::ImuSample>(batch_.data(), count));
+      }
+    }
+  }
+
+  /* Latest attitude, safe to call from any thread */
+  float GetRoll() const { return roll_.load(std::memory_order_relaxed); }
+  float GetPitch() const { return pitch_.load(std::memory_order_relaxed); }
+  float GetYaw() const { return yaw_.load(std::memory_order_relaxed); }
+
+  /* True once the fast convergence phase is over and the attitude holds */
+  bool IsConverged() const {
+    return converged_.load(std::memory_order_acquire);
+  }
+
+  /* Samples dropped because the fusion thread fell behind */
+  uint64_t GetDroppedSamples() const { return input_.Dropped(); }
+
+  /**
+   * @brief Fuses a batch of samples in order and publishes each attitude.
+   */
+  void Update(std::span<const Type::ImuSample> samples) {
+    for (const auto& sample : samples) {
+      Update(sample);
       GetEulr();
+      if (recorder_.IsRecording()) {
+        recorder_.Push(MakeRecord(sample));
+      }
     }
   }
 
+  /**
+   * @brief Fuses one sample, integrating over the time since the previous
+   * one in TimeMode::MEASURED.
+   */
+  void Update(const Type::ImuSample& sample) {
+    accel_ = sample.accel;
+    gyro_ = sample.gyro;
+    timestamp_us_ = sample.timestamp_us;
+
+    dt_ = NOMINAL_DT;
+    if (time_mode_ == TimeMode::MEASURED && last_timestamp_us_ != 0 &&
+        sample.timestamp_us > last_timestamp_us_) {
+      dt_ = std::clamp(
+          static_cast<float>(sample.timestamp_us - last_timestamp_us_) * 1e-6f,
+          MIN_DT, MAX_DT);
+    }
+    if (last_timestamp_us_ == 0) {
+      /* Fast convergence starts with the first sample, not construction */
+      start_ = std::chrono::microseconds(sample.timestamp_us);
+    }
+    last_timestamp_us_ = sample.timestamp_us;
+    now_ = std::chrono::microseconds(sample.timestamp_us);
+
+    Update();
+  }
+
+  /* Fuses accel_ and gyro_ over dt_ */
   void Update() {
-    static float recip_norm;
-    static float s0, s1, s2, s3;
-    static float q_dot1, q_dot2, q_dot3, q_dot4;
-    static float q_2q0, q_2q1, q_2q2, q_2q3, q_4q0, q_4q1, q_4q2, q_8q1, q_8q2,
-        q0q0, q1q1, q2q2, q3q3;
+    /* Converge quickly during the first second */
+    const bool CONVERGING = now_.count() - start_.count() <= CONVERGE_US;
+    float beta = CONVERGING ? 10.0f : 2.0f;
+    if (!CONVERGING && !converged_.load(std::memory_order_relaxed)) {
+      converged_.store(true, std::memory_order_release);
+    }
 
-    now_ = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    UpdateNeon(beta);
+#else
+    UpdateScalar(beta);
+#endif
+  }
 
-    dt_ = 0.001f;
-    last_wakeup_ = now_;
+  void UpdateScalar(float beta) {
+    float recip_norm;
+    float s0, s1, s2, s3;
+    float q_dot1, q_dot2, q_dot3, q_dot4;
+    float q_2q0, q_2q1, q_2q2, q_2q3, q_4q0, q_4q1, q_4q2, q_8q1, q_8q2, q0q0,
+        q1q1, q2q2, q3q3;
 
     float ax = accel_.x;
     float ay = accel_.y;
@@ -108,19 +201,11 @@ class AHRS {
       s2 *= recip_norm;
       s3 *= recip_norm;
 
-      float beta_imu = 0;
-
-      if (now_.count() - start_.count() > 1000000) {
-        beta_imu = 2.0f;
-      } else {
-        beta_imu = 10.0f;
-      }
-
       /* Apply feedback step */
-      q_dot1 -= beta_imu * s0;
-      q_dot2 -= beta_imu * s1;
-      q_dot3 -= beta_imu * s2;
-      q_dot4 -= beta_imu * s3;
+      q_dot1 -= beta * s0;
+      q_dot2 -= beta * s1;
+      q_dot3 -= beta * s2;
+      q_dot4 -= beta * s3;
     }
 
     /* Integrate rate of change of quaternion to yield quaternion */
@@ -138,6 +223,70 @@ class AHRS {
     quat_.q3 *= recip_norm;
   }
 
+#if defined(__ARM_NEON) && defined(__aarch64__)
+  /**
+   * @brief NEON form of UpdateScalar with the quaternion in one register.
+   *
+   * q_dot = 0.5 * (A * gx + B * gy + C * gz) with A = [-q1, q0, q3, -q2],
+   * B = [-q2, -q3, q0, q1], C = [-q3, q2, -q1, q0]; the gradient is
+   * J^T * f with the same lane permutations.
+   */
+  void UpdateNeon(float beta) {
+    static constexpr float SIGN_A[4] = {-1.0f, 1.0f, 1.0f, -1.0f};
+    static constexpr float SIGN_B[4] = {-1.0f, -1.0f, 1.0f, 1.0f};
+    static constexpr float SIGN_C[4] = {-1.0f, 1.0f, -1.0f, 1.0f};
+    static constexpr float SIGN_J1[4] = {-2.0f, 2.0f, -2.0f, 2.0f};
+    static constexpr float SCALE_J3[4] = {0.0f, -4.0f, -4.0f, 0.0f};
+
+    float32x4_t q = vld1q_f32(&quat_.q0);
+    float32x4_t q_rev = vrev64q_f32(q);        /* [q1, q0, q3, q2] */
+    float32x4_t q_swap = vextq_f32(q, q, 2);   /* [q2, q3, q0, q1] */
+    float32x4_t q_back = vrev64q_f32(q_swap);  /* [q3, q2, q1, q0] */
+
+    /* Rate of change of quaternion from gyroscope */
+    float32x4_t q_dot = vmulq_n_f32(vmulq_f32(q_rev, vld1q_f32(SIGN_A)),
+                                    gyro_.x);
+    q_dot = vfmaq_n_f32(q_dot, vmulq_f32(q_swap, vld1q_f32(SIGN_B)), gyro_.y);
+    q_dot = vfmaq_n_f32(q_dot, vmulq_f32(q_back, vld1q_f32(SIGN_C)), gyro_.z);
+    q_dot = vmulq_n_f32(q_dot, 0.5f);
+
+    float ax = accel_.x;
+    float ay = accel_.y;
+    float az = accel_.z;
+
+    if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+      /* Normalise accelerometer measurement */
+      float recip_norm = 1.0f / sqrtf(ax * ax + ay * ay + az * az);
+      ax *= recip_norm;
+      ay *= recip_norm;
+      az *= recip_norm;
+
+      /* Objective function: gravity predicted by q minus measured */
+      float f1 =
+          2.0f * (quat_.q1 * quat_.q3 - quat_.q0 * quat_.q2) - ax;
+      float f2 =
+          2.0f * (quat_.q0 * quat_.q1 + quat_.q2 * quat_.q3) - ay;
+      float f3 = 1.0f - 2.0f * (quat_.q1 * quat_.q1 + quat_.q2 * quat_.q2) - az;
+
+      /* Gradient J^T * f */
+      float32x4_t s = vmulq_n_f32(vmulq_f32(q_swap, vld1q_f32(SIGN_J1)), f1);
+      s = vfmaq_n_f32(s, vmulq_n_f32(q_rev, 2.0f), f2);
+      s = vfmaq_n_f32(s, vmulq_f32(q, vld1q_f32(SCALE_J3)), f3);
+
+      /* Normalise step magnitude and apply feedback step */
+      float norm = vaddvq_f32(vmulq_f32(s, s));
+      if (norm > 0.0f) {
+        q_dot = vfmsq_n_f32(q_dot, s, beta / sqrtf(norm));
+      }
+    }
+
+    /* Integrate and normalise */
+    q = vfmaq_n_f32(q, q_dot, dt_);
+    q = vmulq_n_f32(q, 1.0f / sqrtf(vaddvq_f32(vmulq_f32(q, q))));
+    vst1q_f32(&quat_.q0, q);
+  }
+#endif
+
   void GetEulr() {
     float yaw = std::atan2(2 * (quat_.q0 * quat_.q3 + quat_.q1 * quat_.q2),
                            1 - 2 * (quat_.q3 * quat_.q3 + quat_.q2 * quat_.q2));
@@ -150,8 +299,12 @@ class AHRS {
     eulr_.rol = roll;
     eulr_.yaw = yaw;
 
+    roll_.store(eulr_.rol.Value(), std::memory_order_relaxed);
+    pitch_.store(eulr_.pit.Value(), std::memory_order_relaxed);
+    yaw_.store(eulr_.yaw.Value(), std::memory_order_relaxed);
+
     if (data_callback_) {
-      data_callback_(accel_, gyro_, eulr_);
+      data_callback_(Type::ImuSample{accel_, gyro_, timestamp_us_}, eulr_);
     }
   }
 
@@ -176,36 +329,30 @@ class AHRS {
         eulr_without_yaw_.pit.Value(), eulr_without_yaw_.yaw.Value());
   }
 
-  void StartRecordData() {
-    record_thread_ = std::thread(&AHRS::RecordTask, this);
+  /**
+   * @brief Record every fused sample to a binary dataset file.
+   * @param path Output file, see DataRecorder for the format
+   * @param label Gesture label stored with each record
+   * @return false if the recording could not be started
+   */
+  bool StartRecordData(const std::string& path = "imu_data.bin",
+                       int label = 1) {
+    record_label_.store(label, std::memory_order_relaxed);
+    return recorder_.Start(path);
   }
 
-  void RecordTask() {
-    std::ofstream csv_file("imu_data.csv");
-    std::chrono::microseconds period_us(static_cast<int>(1000));
-
-    std::chrono::steady_clock::time_point next_time, start_time;
-    next_time = start_time = std::chrono::steady_clock::now();
-    csv_file << "timestamp,ax,ay,az,gx,gy,gz,q0,q1,q2,q3,rol,pit,yaw,label\n";
-    while (true) {
-      csv_file << std::to_string((next_time.time_since_epoch().count() -
-                                  start_time.time_since_epoch().count()) /
-                                 1000)
-               << "," << accel_.x << "," << accel_.y << "," << accel_.z << ","
-               << gyro_.x << "," << gyro_.y << "," << gyro_.z << "," << quat_.q0
-               << "," << quat_.q1 << "," << quat_.q2 << "," << quat_.q3 << ","
-               << eulr_.rol.Value() << "," << eulr_.pit.Value() << ","
-               << eulr_.yaw.Value() << "," << "1\n";
-      csv_file.flush();
-
-      next_time += period_us;
-      std::this_thread::sleep_until(next_time);
-    }
+  /* Change the label of the records that follow */
+  void SetRecordLabel(int label) {
+    record_label_.store(label, std::memory_order_relaxed);
   }
 
+  void StopRecordData() { recorder_.Stop(); }
+
+  const DataRecorder& GetRecorder() const { return recorder_; }
+
   void RegisterDataCallback(
-      const std::function<void(const Type::Vector3&, const Type::Vector3&,
-                               const Type::Eulr&)>& callback) {
+      const std::function<void(const Type::ImuSample&, const Type::Eulr&)>&
+          callback) {
     data_callback_ = callback;
   }
 
@@ -218,16 +365,17 @@ class AHRS {
     gyro_ = {0.0f, 0.0f, 0.0f};
 
     auto current_time = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
+        std::chrono::steady_clock::now().time_since_epoch());
 
-    start_ = now_ = last_wakeup_ = current_time;
-    dt_ = 0.001f;  // 1ms sample period
+    start_ = now_ = current_time;
+    last_timestamp_us_ = 0;
 
     auto t0 = std::chrono::high_resolution_clock::now();
 
     // ---- Run Update ----
     auto t1 = std::chrono::high_resolution_clock::now();
-    Update();
+    Update(Type::ImuSample{accel_, gyro_,
+                           static_cast<uint64_t>(current_time.count())});
     auto t2 = std::chrono::high_resolution_clock::now();
 
     // ---- Convert to Euler angles ----
@@ -289,6 +437,41 @@ class AHRS {
     std::cout << std::format(
         "[Timing] Total                 : {:>8.2f} µs\n",
         std::chrono::duration<float, std::micro>(t5 - t0).count());
+
+    // ---- Batch update with measured dt ----
+    constexpr size_t BATCH = 1000;
+    std::vector<Type::ImuSample> samples(BATCH);
+    for (size_t i = 0; i < BATCH; ++i) {
+      samples[i] = {{0.01f, 0.01f, 9.8f},
+                    {0.1f, -0.05f, 0.02f},
+                    static_cast<uint64_t>(current_time.count()) + 1000 * i};
+    }
+
+    auto t6 = std::chrono::high_resolution_clock::now();
+    for (const auto& sample : samples) {
+      Update(sample);
+    }
+    auto t7 = std::chrono::high_resolution_clock::now();
+
+    std::cout << std::format(
+        "[Timing] Update() per sample   : {:>8.2f} ns (dt={:.6f} s)\n",
+        std::chrono::duration<float, std::nano>(t7 - t6).count() / BATCH,
+        dt_);
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    // ---- NEON against scalar reference ----
+    Type::Quaternion start = quat_;
+    UpdateScalar(2.0f);
+    Type::Quaternion scalar = quat_;
+    quat_ = start;
+    UpdateNeon(2.0f);
+    float diff = std::fabs(scalar.q0 - quat_.q0) +
+                 std::fabs(scalar.q1 - quat_.q1) +
+                 std::fabs(scalar.q2 - quat_.q2) +
+                 std::fabs(scalar.q3 - quat_.q3);
+    std::cout << std::format("[UnitTest] {} NEON matches scalar update ({:.2e})\n",
+                             diff < 1e-5f ? "✅" : "❌", diff);
+#endif
   }
 
   Type::Quaternion quat_{};
@@ -297,7 +480,15 @@ class AHRS {
   Type::Vector3 gyro_{};
 
  private:
-  std::chrono::duration<uint64_t, std::ratio<1, 1000000>> last_wakeup_;
+  /* Integration step limits for TimeMode::MEASURED */
+  static constexpr float NOMINAL_DT = 0.001f; /* IMU sample period */
+  static constexpr float MIN_DT = 0.0001f;
+  static constexpr float MAX_DT = 0.01f; /* Caps gaps, e.g. a FIFO reset */
+  static constexpr uint64_t CONVERGE_US = 1000000; /* High-gain phase */
+
+  TimeMode time_mode_;
+  uint64_t last_timestamp_us_ = 0; /* Timestamp of the previous sample */
+
   std::chrono::duration<uint64_t, std::ratio<1, 1000000>> now_;
   std::chrono::duration<uint64_t, std::ratio<1, 1000000>> start_;
   float dt_ = 0.0f;
@@ -307,11 +498,32 @@ class AHRS {
 
   Type::Vector3 filtered_accel_{};
 
-  std::binary_semaphore ready_;
+  /* Sample pipeline from the IMU, drained in batches */
+  SpscRing<Type::ImuSample, 256> input_;
+  std::array<Type::ImuSample, 64> batch_{};
+  uint64_t timestamp_us_ = 0; /* Timestamp of the sample being fused */
+
+  /* Published attitude for other threads */
+  std::atomic<float> roll_{0.0f};
+  std::atomic<float> pitch_{0.0f};
+  std::atomic<float> yaw_{0.0f};
+  std::atomic<bool> converged_{false};
 
-  std::function<void(const Type::Vector3& acc, const Type::Vector3& gyro,
-                     const Type::Eulr& eulr)>
+  std::function<void(const Type::ImuSample& sample, const Type::Eulr& eulr)>
       data_callback_;
 
-  std::thread thread_, record_thread_; /* Thread */
+  /* Dataset recording, fed from the fusion thread */
+  DataRecord MakeRecord(const Type::ImuSample& sample) const {
+    return DataRecord{sample.timestamp_us,
+                      {sample.accel.x, sample.accel.y, sample.accel.z},
+                      {sample.gyro.x, sample.gyro.y, sample.gyro.z},
+                      {quat_.q0, quat_.q1, quat_.q2, quat_.q3},
+                      {eulr_.rol.Value(), eulr_.pit.Value(), eulr_.yaw.Value()},
+                      record_label_.load(std::memory_order_relaxed)};
+  }
+
+  DataRecorder recorder_;
+  std::atomic<int> record_label_{1};
+
+  std::thread thread_; /* Thread */
 };
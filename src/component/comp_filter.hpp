@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <iostream>
+#include <type_traits>
+
+/**
+ * @brief Moving average over the last N samples.
+ *
+ * Keeps a running sum next to a fixed ring, so each sample costs one add
+ * and one subtract regardless of N and nothing is allocated.
+ *
+ * @tparam T Sample type
+ * @tparam N Window length
+ */
+template <typename T, size_t N>
+class MovingAverage {
+  static_assert(N > 0, "MovingAverage needs a non-empty window");
+  static_assert(std::is_arithmetic_v<T>, "MovingAverage needs a number type");
+
+ public:
+  /// Add a sample, dropping the oldest once full; returns the new average
+  T Push(T value) {
+    if (count_ == N) {
+      sum_ -= samples_[head_];
+    } else {
+      count_++;
+    }
+    samples_[head_] = value;
+    sum_ += value;
+    head_ = (head_ + 1) % N;
+    return Value();
+  }
+
+  /// Average of the samples so far, zero if empty
+  T Value() const { return count_ ? static_cast<T>(sum_ / count_) : T{}; }
+
+  bool Full() const { return count_ == N; }
+  size_t Size() const { return count_; }
+
+  void Clear() {
+    head_ = 0;
+    count_ = 0;
+    sum_ = 0;
+  }
+
+  /// Checks the window on a fresh filter of the same shape
+  void RunUnitTest() {
+    std::cout << "[MovingAverage::UnitTest] Starting filter test...\n";
+
+    MovingAverage test;
+    bool partial = true;
+    for (size_t i = 1; i <= N; ++i) {
+      test.Push(static_cast<T>(i));
+      /* Mean of 1..i while the window is filling */
+      partial &= std::fabs(static_cast<double>(test.Value()) -
+                           static_cast<double>(i + 1) / 2.0) < 1.0;
+    }
+    bool full = test.Full() && test.Size() == N;
+
+    /* A constant run pushes every earlier sample out of the window */
+    for (size_t i = 0; i < N; ++i) {
+      test.Push(static_cast<T>(7));
+    }
+    bool steady = test.Value() == static_cast<T>(7);
+
+    std::cout << std::format("[Test] Window mean → {}\n",
+                             partial && full && steady
+                                 ? "✅ Fills, slides and settles"
+                                 : "❌ Wrong mean");
+  }
+
+ private:
+  /* Floating point sums in double so rounding does not build up */
+  using Sum = std::conditional_t<std::is_floating_point_v<T>, double, T>;
+
+  std::array<T, N> samples_{};
+  size_t head_ = 0;  /* Oldest sample once full */
+  size_t count_ = 0; /* Valid samples */
+  Sum sum_ = 0;
+};
+
+/**
+ * @brief Maps a value to integer levels of width `step`, with hysteresis.
+ *
+ * The level only changes once the value is `hysteresis` steps past the
+ * boundary of the current level, so noise around a boundary does not
+ * toggle it. Update() reports whether the level changed, so callers can
+ * skip work while it holds.
+ */
+class HysteresisLevel {
+ public:
+  /**
+   * @param step Width of one level in input units
+   * @param hysteresis Extra distance past a boundary, in fractions of step
+   * @param min_level Lowest level reported
+   * @param max_level Highest level reported
+   */
+  HysteresisLevel(float step, float hysteresis, int min_level, int max_level)
+      : step_(step),
+        hysteresis_(hysteresis),
+        min_level_(min_level),
+        max_level_(max_level),
+        level_(min_level) {}
+
+  /// Feed a value; returns true if the level changed (or was first set)
+  bool Update(float value) {
+    float position = value / step_;
+    int target = std::clamp(static_cast<int>(std::floor(position)),
+                            min_level_, max_level_);
+    if (initialized_ && target != level_) {
+      /* Stay unless the value is clearly inside the new level */
+      float low = static_cast<float>(level_) - hysteresis_;
+      float high = static_cast<float>(level_ + 1) + hysteresis_;
+      if (position >= low && position < high) {
+        return false;
+      }
+    }
+    if (initialized_ && target == level_) {
+      return false;
+    }
+    initialized_ = true;
+    level_ = target;
+    return true;
+  }
+
+  int Level() const { return level_; }
+
+  /// Noise across a boundary must not toggle the level, a real step must
+  void RunUnitTest() {
+    std::cout << "[HysteresisLevel::UnitTest] Starting level test...\n";
+
+    HysteresisLevel test(step_, hysteresis_, min_level_, max_level_);
+    const float BOUNDARY = step_ * static_cast<float>(min_level_ + 1);
+    test.Update(BOUNDARY - step_ * 0.5f);
+    const int START = test.Level();
+
+    /* Jitter of half the hysteresis band either side of the boundary */
+    int changes = 0;
+    for (int i = 0; i < 100; ++i) {
+      float jitter = (i % 2 ? 0.5f : -0.5f) * hysteresis_ * step_;
+      changes += test.Update(BOUNDARY + jitter) ? 1 : 0;
+    }
+    bool held = changes == 0 && test.Level() == START;
+
+    bool stepped = test.Update(BOUNDARY + step_ * 0.5f) &&
+                   test.Level() == START + 1;
+
+    std::cout << std::format("[Test] Boundary noise → {}\n",
+                             held && stepped
+                                 ? "✅ Level held, step followed"
+                                 : "❌ Level toggled");
+  }
+
+ private:
+  float step_;
+  float hysteresis_;
+  int min_level_;
+  int max_level_;
+  int level_;
+  bool initialized_ = false;
+};
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <array>
+#include <mutex>
 #include <semaphore>
-#include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "comp_sand.hpp"
+#include "comp_timer.hpp"
 #include "max7219.hpp"
 
 /**
@@ -33,7 +35,20 @@ class CompGuiX {
   explicit CompGuiX(Max7219<8>& display,
                     Orientation ori = Orientation::Portrait)
       : display_(display), orientation_(ori) {
-    thread_ = std::thread(&CompGuiX::ThreadFun, this);
+    sand_timer_ = TimerService::Default().AddPeriodic(
+        SAND_PERIOD, [this]() { SandTick(); }, SAND_START_DELAY);
+  }
+
+  ~CompGuiX() { TimerService::Default().Remove(sand_timer_); }
+
+  /**
+   * @brief Stop the sand animation job, waiting for a running step
+   *
+   * For callers that drive RenderHourglass() on their own clock.
+   */
+  void StopSandTimer() {
+    TimerService::Default().Remove(sand_timer_);
+    sand_timer_ = TimerService::INVALID_TIMER;
   }
 
   /// Update display orientation
@@ -48,9 +63,8 @@ class CompGuiX {
     int tens = (value / 10) % 10;
     int ones = value % 10;
 
-    auto [baseX, baseY] = REGION_OFFSETSS[static_cast<int>(region)];
-    DrawDigit(baseX, baseY, FONT[tens], region);
-    DrawDigit(baseX + 5, baseY, FONT[ones], region);  // Right-aligned
+    BlitGlyph(Glyph(orientation_, region, 0, tens));
+    BlitGlyph(Glyph(orientation_, region, 1, ones));
   }
 
   /// Clear display buffer
@@ -63,67 +77,151 @@ class CompGuiX {
   void SetGravityDegree(float gravity_angle) {
     float deg = fmodf(
         630.0f - gravity_angle * 180.0f / static_cast<float>(M_PI), 360.0f);
+    std::lock_guard<std::mutex> lock(sand_mutex_);
     gravity_deg_ = deg;
+
+    /* A settled pile only needs waking once gravity really turned */
+    float delta = fabsf(deg - settled_deg_);
+    delta = fminf(delta, 360.0f - delta);
+    if (settled_ && delta > GRAVITY_WAKE_DEG) {
+      settled_ = false;
+      WakeSand();
+    }
   }
 
-  bool sand_enable_ = false;      ///< Sand animation toggle
-  SandGrid grid_up_, grid_down_;  ///< Sand particle containers
+  SandEngine grid_up_, grid_down_;  ///< Sand particle containers
   float gravity_deg_ = 0.0f;      ///< Gravity direction (degrees)
 
   /// Enable sand simulation
-  void SandEnable() { sand_enable_ = true; }
+  void SandEnable() {
+    std::lock_guard<std::mutex> lock(sand_mutex_);
+    if (!sand_enable_) {
+      sand_enable_ = true;
+      settled_ = false;
+      WakeSand();
+    }
+  }
 
   /// Disable sand simulation
-  void SandDisable() { sand_enable_ = false; }
+  void SandDisable() {
+    std::lock_guard<std::mutex> lock(sand_mutex_);
+    sand_enable_ = false;
+  }
 
-  /// Animation thread entry point
-  void ThreadFun() {
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-  init:
-    grid_up_.Clear();
-    grid_down_.Clear();
-
-    // Initial fill animation
-    for (int i = 0; i < 128;) {
-      if (grid_up_.AddNewSand()) {
-        i++;
-      }
-      grid_up_.StepOnce(0);
-      RenderHourglass(&grid_up_, &grid_down_);
-      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  /**
+   * @brief Let one grain fall through the neck if the lower bulb holds fewer
+   * than `target_down_count` grains
+   * @return true if a grain was transferred
+   */
+  bool TransferSand(int target_down_count) {
+    std::lock_guard<std::mutex> lock(sand_mutex_);
+    if (grid_down_.Count() >= target_down_count ||
+        !SandEngine::MoveSand(&grid_up_, &grid_down_, gravity_deg_)) {
+      return false;
     }
+    settled_ = false;
+    WakeSand();
+    return true;
+  }
 
-    // Settling phase
-    for (int i = 0; i < 16; i++) {
-      grid_up_.StepOnce(0);
-      RenderHourglass(&grid_up_, &grid_down_);
-      std::this_thread::sleep_for(std::chrono::milliseconds(25));
-    }
+  /**
+   * @brief Sand animation step, run every SAND_PERIOD on the timer service
+   *
+   * Fills the upper bulb, lets it settle, then simulates both bulbs. The
+   * timer is paused while the sand is disabled or at rest and resumed by
+   * anything that can set it moving again.
+   */
+  void SandTick() {
+    std::lock_guard<std::mutex> lock(sand_mutex_);
+    switch (sand_phase_) {
+      case SandPhase::FILL:
+        if (sand_steps_ == 0) {
+          grid_up_.Clear();
+          grid_down_.Clear();
+        }
+        if (grid_up_.AddNewSand()) {
+          sand_steps_++;
+        }
+        grid_up_.StepOnce(0);
+        RenderHourglass(&grid_up_, &grid_down_);
+        if (sand_steps_ == FILL_GRAINS) {
+          sand_phase_ = SandPhase::SETTLE;
+          sand_steps_ = 0;
+        }
+        break;
 
-    // Main simulation loop
-    while (1) {
-      if (sand_enable_) {
+      case SandPhase::SETTLE:
+        grid_up_.StepOnce(0);
+        RenderHourglass(&grid_up_, &grid_down_);
+        if (++sand_steps_ == SETTLE_STEPS) {
+          sand_phase_ = SandPhase::RUN;
+          sand_steps_ = 0;
+        }
+        break;
+
+      case SandPhase::RUN: {
+        if (!sand_enable_ || (settled_ && !reset_)) {
+          sand_paused_ = true;
+          TimerService::Default().Pause(sand_timer_);
+          break;
+        }
         if (reset_) {
           reset_ = false;
-          goto init;
+          settled_ = false;
+          sand_phase_ = SandPhase::FILL;
+          sand_steps_ = 0;
+          break;
         }
-        grid_up_.StepOnce(gravity_deg_);
-        grid_down_.StepOnce(gravity_deg_);
+        bool moved = grid_up_.StepOnce(gravity_deg_);
+        moved = grid_down_.StepOnce(gravity_deg_) || moved;
         RenderHourglass(&grid_up_, &grid_down_);
+        if (!moved) {
+          settled_ = true;
+          settled_deg_ = gravity_deg_;
+        }
+        break;
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(25));
     }
   }
 
  private:
+  /// Gravity change that wakes a settled pile (degrees)
+  static constexpr float GRAVITY_WAKE_DEG = 5.0f;
+
   // Hardware interface
   Max7219<8>& display_;      ///< LED matrix driver
   Orientation orientation_;  ///< Current orientation
-  bool reset_ = false;       ///< Reset flag
-  std::thread thread_;       ///< Animation thread
+
+  /// Sand animation phases, advanced by SandTick()
+  enum class SandPhase : uint8_t { FILL, SETTLE, RUN };
+
+  static constexpr std::chrono::milliseconds SAND_PERIOD{25};
+  static constexpr std::chrono::milliseconds SAND_START_DELAY{500};
+  static constexpr int FILL_GRAINS = 128;  ///< Grains poured in at start
+  static constexpr int SETTLE_STEPS = 16;  ///< Steps after the fill
+
+  /// Resume the paused sand timer (sand_mutex_ held)
+  void WakeSand() {
+    if (sand_paused_) {
+      sand_paused_ = false;
+      TimerService::Default().Resume(sand_timer_);
+    }
+  }
+
+  // Sand state shared with the timer job, guarded by sand_mutex_
+  std::mutex sand_mutex_;
+  SandPhase sand_phase_ = SandPhase::FILL;
+  int sand_steps_ = 0;        ///< Progress within the current phase
+  bool sand_paused_ = false;  ///< Timer paused until WakeSand()
+  bool sand_enable_ = false;  ///< Sand animation toggle
+  bool reset_ = false;        ///< Reset flag
+  bool settled_ = false;      ///< No grain moved in the last step
+  float settled_deg_ = 0.0f;  ///< Gravity when the pile settled
+
+  TimerService::TimerId sand_timer_ = TimerService::INVALID_TIMER;
 
   // 7-segment font definitions
-  static constexpr std::array<std::array<std::string, 7>, 10> FONT = {{
+  static constexpr std::array<std::array<std::string_view, 7>, 10> FONT = {{
       {"01110", "10001", "10011", "10101", "11001", "10001", "01110"},  // 0
       {"00100", "01100", "00100", "00100", "00100", "00100", "01110"},  // 1
       {"01110", "10001", "00001", "00010", "00100", "01000", "11111"},  // 2
@@ -144,35 +242,46 @@ class CompGuiX {
       {0, 1},   // SCREEN_1_PORTRAIT
   }};
 
-  /**
-   * @brief Render digit using 5x7 bitmap
-   * @param leftX Leftmost X coordinate
-   * @param topY Top Y coordinate
-   * @param bitmap Font glyph data
-   * @param region Target display region
-   */
-  void DrawDigit(int leftX, int topY, const std::array<std::string, 7>& bitmap,
-                 RegionID region) {
-    for (int dy = 0; dy < 7; ++dy) {
-      for (int dx = 0; dx < 5; ++dx) {
-        if (bitmap[6 - dy][dx] == '1') {
-          PlotRotated45(leftX + dx, topY + dy, region, true);
-        }
-      }
-    }
+  /// One row of one chip to OR into the framebuffer
+  struct MaskRow {
+    uint8_t chip;
+    uint8_t row;
+    uint8_t bits;
+  };
+
+  /// A glyph placed and rotated into per-chip rows
+  struct GlyphMask {
+    std::array<MaskRow, 32> rows{};
+    uint8_t count = 0;
+  };
+
+  static constexpr int ORIENTATION_NUM = 2;
+  static constexpr int REGION_NUM = 4;
+  static constexpr int DIGIT_POSITIONS = 2;  // Tens, ones
+
+  static constexpr size_t GlyphIndex(Orientation ori, RegionID region,
+                                     int position, int digit) {
+    return ((static_cast<size_t>(ori) * REGION_NUM +
+             static_cast<size_t>(region)) *
+                DIGIT_POSITIONS +
+            position) *
+               10 +
+           digit;
   }
 
   /**
    * @brief Coordinate transformation for 45° rotated displays
+   * @param ori Display orientation
    * @param lx Logical X coordinate
    * @param ly Logical Y coordinate
    * @param region Target display region
-   * @param on Pixel state (true = on)
+   * @param row Composite matrix row output
+   * @param col Composite matrix column output
+   * @return true if the pixel lies on the 16x32 matrix
    */
-  void PlotRotated45(int lx, int ly, RegionID region, bool on) {
-    int row = 0, col = 0;
-
-    if (orientation_ != Orientation::Landscape) {
+  static constexpr bool Rotate45(Orientation ori, int lx, int ly,
+                                 RegionID region, int& row, int& col) {
+    if (ori != Orientation::Landscape) {
       // Portrait mode transform
       row = lx + ly;
       col = -lx + ly;
@@ -194,8 +303,104 @@ class CompGuiX {
       }
     }
 
-    if (row >= 0 && row < 16 && col >= 0 && col < 32) {
-      display_.DrawPixelMatrix2(row, col, on);
+    return row >= 0 && row < 16 && col >= 0 && col < 32;
+  }
+
+  /// Rasterize one 5x7 glyph into chip rows, merging pixels per row
+  static constexpr GlyphMask BuildGlyphMask(Orientation ori, RegionID region,
+                                            int position, int digit) {
+    GlyphMask mask;
+    auto [base_x, base_y] = REGION_OFFSETSS[static_cast<int>(region)];
+    base_x += position * 5;  // Ones digit is right of the tens digit
+
+    for (int dy = 0; dy < 7; ++dy) {
+      for (int dx = 0; dx < 5; ++dx) {
+        if (FONT[digit][6 - dy][dx] != '1') {
+          continue;
+        }
+
+        int row = 0, col = 0;
+        if (!Rotate45(ori, base_x + dx, base_y + dy, region, row, col)) {
+          continue;
+        }
+
+        auto pixel = Max7219<8>::MapMatrix2(static_cast<uint8_t>(row),
+                                            static_cast<uint8_t>(col));
+        uint8_t i = 0;
+        while (i < mask.count && (mask.rows[i].chip != pixel.chip ||
+                                  mask.rows[i].row != pixel.row)) {
+          ++i;
+        }
+        if (i == mask.count) {
+          mask.rows[mask.count++] = {pixel.chip, pixel.row, 0};
+        }
+        mask.rows[i].bits |= static_cast<uint8_t>(1 << pixel.col);
+      }
+    }
+    return mask;
+  }
+
+  static constexpr auto BuildGlyphMasks() {
+    std::array<GlyphMask,
+               ORIENTATION_NUM * REGION_NUM * DIGIT_POSITIONS * 10>
+        masks{};
+    for (int o = 0; o < ORIENTATION_NUM; ++o) {
+      for (int r = 0; r < REGION_NUM; ++r) {
+        for (int p = 0; p < DIGIT_POSITIONS; ++p) {
+          for (int d = 0; d < 10; ++d) {
+            auto ori = static_cast<Orientation>(o);
+            auto region = static_cast<RegionID>(r);
+            masks[GlyphIndex(ori, region, p, d)] =
+                BuildGlyphMask(ori, region, p, d);
+          }
+        }
+      }
+    }
+    return masks;
+  }
+
+  /// Every digit at every placement, rasterized at compile time
+  static const GlyphMask& Glyph(Orientation ori, RegionID region,
+                                int position, int digit) {
+    static constexpr auto GLYPH_MASKS = BuildGlyphMasks();
+    return GLYPH_MASKS[GlyphIndex(ori, region, position, digit)];
+  }
+
+  /// Four chips of 8 rows for a 16x16 icon
+  using IconMask = std::array<std::array<uint8_t, 8>, 4>;
+
+  /// Pack a 16x16 icon into rows of chips (i * 2 + j), bit l = column l
+  static constexpr IconMask BuildIconMask(const bool (&icon)[16][16]) {
+    IconMask mask{};
+    for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < 2; j++) {
+        for (int k = 0; k < 8; k++) {
+          uint8_t bits = 0;
+          for (int l = 0; l < 8; l++) {
+            if (icon[k + i * 8][l + j * 8]) {
+              bits |= static_cast<uint8_t>(1 << l);
+            }
+          }
+          mask[i * 2 + j][k] = bits;
+        }
+      }
+    }
+    return mask;
+  }
+
+  /// OR a precomputed glyph into the framebuffer
+  void BlitGlyph(const GlyphMask& mask) {
+    for (uint8_t i = 0; i < mask.count; ++i) {
+      display_.OrRow(mask.rows[i].chip, mask.rows[i].row, mask.rows[i].bits);
+    }
+  }
+
+  /// OR a precomputed icon into chips first_chip .. first_chip + 3
+  void BlitIcon(const IconMask& mask, size_t first_chip) {
+    for (size_t c = 0; c < mask.size(); c++) {
+      for (uint8_t k = 0; k < 8; k++) {
+        display_.OrRow(first_chip + c, k, mask[c][k]);
+      }
     }
   }
 
@@ -205,19 +410,19 @@ class CompGuiX {
 
   /// Render HH:MM in landscape orientation
   void RenderTimeLandscape(uint8_t hour, uint8_t minute) {
-    display_.Lock();
+    display_.BeginFrame();
     Clear();
     SetOrientation(Orientation::Landscape);
     display_.DrawPixel(3, 7, 4, true);  // Colon top
     display_.DrawPixel(3, 4, 7, true);  // Colon bottom
     Draw(RegionID::SCREEN_0_LANDSCAPE, hour);
     Draw(RegionID::SCREEN_1_LANDSCAPE, minute);
-    display_.Unlock();
+    display_.PublishFrame();
   }
 
   /// Render MM:SS with blinking colon
   void RenderTimeLandscapeMS(uint8_t minutes, uint8_t seconds) {
-    display_.Lock();
+    display_.BeginFrame();
     Clear();
     SetOrientation(Orientation::Landscape);
     if (seconds % 2 == 1) {
@@ -226,12 +431,12 @@ class CompGuiX {
     }
     Draw(RegionID::SCREEN_0_LANDSCAPE, minutes);
     Draw(RegionID::SCREEN_1_LANDSCAPE, seconds);
-    display_.Unlock();
+    display_.PublishFrame();
   }
 
   /// Render HH:MM in portrait orientation
   void RenderTimePortrait(uint8_t hour, uint8_t minute) {
-    display_.Lock();
+    display_.BeginFrame();
     Clear();
     SetOrientation(Orientation::Portrait);
 
@@ -256,12 +461,12 @@ class CompGuiX {
 
     Draw(RegionID::SCREEN_0_PORTRAIT, minute);
     Draw(RegionID::SCREEN_1_PORTRAIT, hour);
-    display_.Unlock();
+    display_.PublishFrame();
   }
 
   /// Render MM:SS with dynamic colon
   void RenderTimePortraitMS(uint8_t minutes, uint8_t seconds) {
-    display_.Lock();
+    display_.BeginFrame();
     Clear();
     SetOrientation(Orientation::Portrait);
 
@@ -287,11 +492,11 @@ class CompGuiX {
 
     Draw(RegionID::SCREEN_0_PORTRAIT, seconds);
     Draw(RegionID::SCREEN_1_PORTRAIT, minutes);
-    display_.Unlock();
+    display_.PublishFrame();
   }
 
   void RenderHumidity(uint8_t humidity) {
-    static constexpr bool ICON[16][16] = {
+    static constexpr bool ICON_BITMAP[16][16] = {
         {0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
         {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
         {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
@@ -309,24 +514,17 @@ class CompGuiX {
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0},
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     };
-    display_.Lock();
+    static constexpr IconMask ICON = BuildIconMask(ICON_BITMAP);
+    display_.BeginFrame();
     Clear();
     SetOrientation(Orientation::Portrait);
-    for (int i = 0; i < 2; i++) {
-      for (int j = 0; j < 2; j++) {
-        for (int k = 0; k < 8; k++) {
-          for (int l = 0; l < 8; l++) {
-            display_.DrawPixel(i * 2 + j + 4, k, l, ICON[k + i * 8][l + j * 8]);
-          }
-        }
-      }
-    }
+    BlitIcon(ICON, 4);
     Draw(RegionID::SCREEN_0_PORTRAIT, humidity);
-    display_.Unlock();
+    display_.PublishFrame();
   }
 
   void RenderTemperature(uint8_t temperature) {
-    static constexpr bool ICON[16][16] = {
+    static constexpr bool ICON_BITMAP[16][16] = {
         {0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
         {0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0},
         {1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0},
@@ -344,24 +542,17 @@ class CompGuiX {
         {0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0},
         {0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
     };
-    display_.Lock();
+    static constexpr IconMask ICON = BuildIconMask(ICON_BITMAP);
+    display_.BeginFrame();
     Clear();
     SetOrientation(Orientation::Portrait);
-    for (int i = 0; i < 2; i++) {
-      for (int j = 0; j < 2; j++) {
-        for (int k = 0; k < 8; k++) {
-          for (int l = 0; l < 8; l++) {
-            display_.DrawPixel(i * 2 + j + 4, k, l, ICON[k + i * 8][l + j * 8]);
-          }
-        }
-      }
-    }
+    BlitIcon(ICON, 4);
     Draw(RegionID::SCREEN_0_PORTRAIT, temperature);
-    display_.Unlock();
+    display_.PublishFrame();
   }
 
   void RenderHourglass(SandGrid* up, SandGrid* down) {
-    display_.Lock();
+    display_.BeginFrame();
     Clear();
     for (int i = 0; i < 2; i++) {
       for (int j = 0; j < 2; j++) {
@@ -384,11 +575,52 @@ class CompGuiX {
         }
       }
     }
-    display_.Unlock();
+    display_.PublishFrame();
+  }
+
+  void RenderHourglass(SandEngine* up, SandEngine* down) {
+    display_.BeginFrame();
+    Clear();
+    DrawHourglass(display_, *up, *down);
+    display_.PublishFrame();
+  }
+
+  /**
+   * @brief Draw both bulbs of a W x H hourglass on a MAX7219 chain
+   *
+   * Each bulb is tiled row-major over (W / 8) x (H / 8) chips; the lower
+   * bulb takes the first chips of the chain and the upper bulb follows.
+   */
+  template <size_t N, int W, int H>
+  static void DrawHourglass(Max7219<N>& display, const SandBitboard<W, H>& up,
+                            const SandBitboard<W, H>& down) {
+    static_assert(W % 8 == 0 && H % 8 == 0,
+                  "Hourglass bulbs must be whole 8x8 chips");
+    constexpr size_t CHIPS_X = W / 8;
+    constexpr size_t CHIPS_Y = H / 8;
+    constexpr size_t BULB_CHIPS = CHIPS_X * CHIPS_Y;
+    static_assert(2 * BULB_CHIPS <= N, "Not enough chips for both bulbs");
+
+    for (size_t i = 0; i < CHIPS_Y; i++) {
+      for (size_t j = 0; j < CHIPS_X; j++) {
+        for (uint8_t k = 0; k < 8; k++) {
+          display.DrawRow(BULB_CHIPS + i * CHIPS_X + j, k,
+                          static_cast<uint8_t>(up.GetRows()[k + i * 8] >>
+                                               (j * 8)));
+          display.DrawRow(i * CHIPS_X + j, k,
+                          static_cast<uint8_t>(down.GetRows()[k + i * 8] >>
+                                               (j * 8)));
+        }
+      }
+    }
   }
 
   /// Reset sand simulation
-  void Reset() { reset_ = true; }
+  void Reset() {
+    std::lock_guard<std::mutex> lock(sand_mutex_);
+    reset_ = true;
+    WakeSand();
+  }
 
   void RunUnitTest() {
     std::cout << "[CompGuiX::UnitTest] Starting GUI unit test...\n";
@@ -417,6 +649,16 @@ class CompGuiX {
     RenderTemperature(23);
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
 
+    std::cout << "[Test] Time 1000 portrait clock renders...\n";
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+      RenderTimePortrait(i % 24, i % 60);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << std::format(
+        "[Test] Render time: {:.3f} µs/frame\n",
+        std::chrono::duration<float, std::micro>(t1 - t0).count() / 1000);
+
     std::cout << "[Test] Enable sand...\n";
     SandEnable();
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -426,6 +668,11 @@ class CompGuiX {
     std::cout << "[Test] Disable sand...\n";
     SandDisable();
 
+    auto stats = display_.GetRefreshStats();
+    std::cout << std::format(
+        "[Test] Refresh rows sent: {} | rows skipped: {} | idle frames: {}\n",
+        stats.rows_sent, stats.rows_skipped, stats.frames_skipped);
+
     std::cout << "[CompGuiX::UnitTest] ✅ Test complete.\n";
   }
 };
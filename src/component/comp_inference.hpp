@@ -2,23 +2,32 @@
 
 #include <onnxruntime_cxx_api.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cctype>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <ctime>
-#include <deque>
+#include <filesystem>
 #include <format>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
-#include <map>
 #include <numeric>
-#include <semaphore>
+#include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
+#include "bsp_thread.hpp"
+#include "comp_metrics.hpp"
+#include "comp_recorder.hpp"
+#include "comp_ring_buffer.hpp"
 #include "comp_type.hpp"
 
 /* Model output categories */
@@ -36,154 +45,355 @@ enum class ModelOutput : int8_t {
   STILL = 9                    /* No motion or slow movement */
 };
 
-/* Mapping model output to string labels */
-static const std::map<ModelOutput, std::string> LABELS = {
-    {ModelOutput::UNRECOGNIZED, "Unrecognized"},
-    {ModelOutput::SHAKE_FORWARD, "Shake Forward"},
-    {ModelOutput::SHAKE_BACKWARD, "Shake Backward"},
-    {ModelOutput::TILT_LEFT, "Tilt Left"},
-    {ModelOutput::TILT_RIGHT, "Tilt Right"},
-    {ModelOutput::FLIP_OVER, "Flip Over"},
-    {ModelOutput::ROTATE_CLOCKWISE, "Rotate Clockwise"},
-    {ModelOutput::ROTATE_COUNTERCLOCKWISE, "Rotate Counterclockwise"},
-    {ModelOutput::SHORT_VIBRATION, "Short Vibration"},
-    {ModelOutput::LONG_VIBRATION, "Long Vibration"},
-    {ModelOutput::STILL, "Still"}};
+/* Model classes, UNRECOGNIZED excluded */
+inline constexpr size_t MODEL_CLASSES = 10;
 
+/* String labels indexed by LabelIndex(), so UNRECOGNIZED comes first */
+inline constexpr std::array<std::string_view, MODEL_CLASSES + 1> LABELS = {
+    "Unrecognized",
+    "Flip Over",
+    "Long Vibration",
+    "Rotate Clockwise",
+    "Rotate Counterclockwise",
+    "Shake Backward",
+    "Shake Forward",
+    "Short Vibration",
+    "Tilt Left",
+    "Tilt Right",
+    "Still"};
+
+constexpr size_t LabelIndex(ModelOutput output) {
+  return static_cast<size_t>(static_cast<int>(output) + 1);
+}
+
+constexpr std::string_view LabelOf(ModelOutput output) {
+  return LABELS[LabelIndex(output)];
+}
+
+static_assert(LabelOf(ModelOutput::STILL) == "Still" &&
+                  LabelOf(ModelOutput::UNRECOGNIZED) == "Unrecognized",
+              "LABELS must follow the ModelOutput order");
+
+/* Outcome of one classification step, passed to the data callback */
+struct InferenceResult {
+  static constexpr size_t TOP_K = 3;
+
+  struct Candidate {
+    ModelOutput label = ModelOutput::UNRECOGNIZED;
+    float probability = 0.0f;
+  };
+
+  /* Category to act on: the voted consensus, or an early confident one */
+  ModelOutput gesture = ModelOutput::UNRECOGNIZED;
+  /* Best classes of this run, most probable first */
+  std::array<Candidate, TOP_K> top{};
+  /* Probability of top[0] minus that of top[1] */
+  float margin = 0.0f;
+  /* Votes for `gesture` in the history */
+  size_t votes = 0;
+  /* Dispatched on margin before the vote agreed */
+  bool early = false;
+};
+
+/* ONNX Runtime session settings for InferenceEngine */
+struct InferenceConfig {
+  /* Graph optimization level applied when the session is created */
+  GraphOptimizationLevel optimization_level = ORT_ENABLE_ALL;
+  /* Threads used inside one operator, capped to the cores outside the
+   * realtime core (see ThreadConfig); 0 uses all of those */
+  int intra_op_threads = 2;
+  /* Threads used across independent operators (sequential when 1) */
+  int inter_op_threads = 1;
+  /* Reuse the allocation plan between runs of the same input shape */
+  bool enable_mem_pattern = true;
+  /* Let idle ORT workers spin instead of sleeping between runs */
+  bool allow_spinning = false;
+  /* Load a pre-optimized "<model>.ort" next to the .onnx file if present */
+  bool prefer_ort_model = true;
+  /* Load the streaming export "<model>_stream.onnx" if present */
+  bool prefer_streaming_model = true;
+  /* Model variant to load, e.g. "int8" for a QDQ-quantized
+   * "<model>_int8.onnx"; empty (or missing file) loads the float model */
+  std::string variant;
+  /* Start the inference thread; off for offline replay (see Replay()) */
+  bool start_thread = true;
+  /* Bind a persistent output buffer instead of allocating one per run */
+  bool use_io_binding = true;
+  /* Skip the model while the window shows no motion (see MotionGate) */
+  bool enable_motion_gate = true;
+  /* Gate window in samples; 0 uses the model window length */
+  size_t motion_gate_window = 0;
+  /* Mean squared angular rate in rad^2/s^2 below which the IMU is still */
+  float gate_gyro_energy = 2.5e-3f;
+  /* Variance of the acceleration magnitude in g^2 below which it is still */
+  float gate_accel_variance = 4e-4f;
+  /* Act on a run whose top-2 probability margin reaches this value without
+   * waiting for consensus; 0 disables. Usually set by the consumer through
+   * InferenceEngine::SetEarlyMargin() */
+  float early_margin = 0.0f;
+};
+
+/**
+ * @brief O(1) per-sample motion detector over a sliding window.
+ *
+ * Tracks the mean squared angular rate and the variance of the
+ * acceleration magnitude over the last `window` samples from running sums,
+ * so each sample costs one add and one subtract. The angular rate is used
+ * as energy rather than variance because a steady rotation is a gesture.
+ */
+class MotionGate {
+ public:
+  void Init(size_t window, float gyro_energy, float accel_variance) {
+    samples_.assign(window > 0 ? window : 1, Entry{});
+    gyro_energy_ = gyro_energy;
+    accel_variance_ = accel_variance;
+    Clear();
+  }
+
+  /**
+   * @brief Add one sample, dropping the oldest once the window is full.
+   * @param gyro Angular rate in rad/s
+   * @param accel_g Acceleration in g
+   */
+  void Push(const Type::Vector3& gyro, const Type::Vector3& accel_g) {
+    Entry entry;
+    entry.gyro_sq = gyro.x * gyro.x + gyro.y * gyro.y + gyro.z * gyro.z;
+    entry.accel = std::sqrt(accel_g.x * accel_g.x + accel_g.y * accel_g.y +
+                            accel_g.z * accel_g.z);
+
+    Entry& oldest = samples_[head_];
+    if (count_ == samples_.size()) {
+      gyro_sq_sum_ -= oldest.gyro_sq;
+      accel_sum_ -= oldest.accel;
+      accel_sq_sum_ -= static_cast<double>(oldest.accel) * oldest.accel;
+    } else {
+      count_++;
+    }
+    oldest = entry;
+    gyro_sq_sum_ += entry.gyro_sq;
+    accel_sum_ += entry.accel;
+    accel_sq_sum_ += static_cast<double>(entry.accel) * entry.accel;
+    if (++head_ == samples_.size()) {
+      head_ = 0;
+    }
+  }
+
+  /// False only when the window is full and both measures are below their
+  /// thresholds; an unfilled window counts as moving
+  bool Moving() const {
+    if (count_ < samples_.size()) {
+      return true;
+    }
+    return GyroEnergy() >= gyro_energy_ || AccelVariance() >= accel_variance_;
+  }
+
+  double GyroEnergy() const { return count_ ? gyro_sq_sum_ / count_ : 0.0; }
+
+  double AccelVariance() const {
+    if (count_ == 0) {
+      return 0.0;
+    }
+    double mean = accel_sum_ / count_;
+    return std::max(0.0, accel_sq_sum_ / count_ - mean * mean);
+  }
+
+  void Clear() {
+    head_ = 0;
+    count_ = 0;
+    gyro_sq_sum_ = 0.0;
+    accel_sum_ = 0.0;
+    accel_sq_sum_ = 0.0;
+  }
+
+ private:
+  struct Entry {
+    float gyro_sq = 0.0f; /* |gyro|^2 */
+    float accel = 0.0f;   /* |accel| in g */
+  };
+
+  std::vector<Entry> samples_;
+  size_t head_ = 0;  /* Oldest entry once full */
+  size_t count_ = 0; /* Valid entries */
+  double gyro_sq_sum_ = 0.0;
+  double accel_sum_ = 0.0;
+  double accel_sq_sum_ = 0.0;
+  float gyro_energy_ = 0.0f;
+  float accel_variance_ = 0.0f;
+};
+
+/**
+ * @brief Gesture classifier running an ONNX model on the attitude stream.
+ *
+ * Two model layouts are supported, told apart by their inputs:
+ *  - Window model (one input, [1, window, features]): the whole window is
+ *    re-run every `update_ratio * window` new samples.
+ *  - Streaming model (input 0 [1, chunk, features] plus state inputs): each
+ *    run only sees the `chunk` newest samples. Every other input is a cached
+ *    state (e.g. the trailing columns a convolution layer needs) whose new
+ *    value the model returns as the output with the same index; the engine
+ *    feeds it back on the next run. The model runs on every chunk, so
+ *    `update_ratio` is ignored and detection latency is one chunk.
+ */
 class InferenceEngine {
  public:
   /**
    * @brief Constructor for the InferenceEngine.
    * @param model_path Path to the ONNX model file.
-   * @param update_ratio Ratio for updating the sensor buffer.
+   * @param update_ratio Ratio for updating the sensor buffer (window models
+   * only).
    * @param confidence_threshold Minimum probability required to accept a
    * prediction.
    * @param history_size Number of past predictions stored for voting.
    * @param min_consensus_votes Minimum votes required to confirm a
    * prediction.
+   * @param config ONNX Runtime session settings.
    */
   explicit InferenceEngine(const std::string& model_path,
                            float update_ratio = 0.1f,
                            float confidence_threshold = 0.6f,
                            size_t history_size = 5,
-                           size_t min_consensus_votes = 3)
-      : env_(ORT_LOGGING_LEVEL_WARNING, "ONNXModel"),
-        session_options_(),
-        session_(env_, model_path.c_str(), session_options_),
+                           size_t min_consensus_votes = 3,
+                           const InferenceConfig& config = InferenceConfig())
+      : config_(config),
+        model_file_(ResolveModelPath(model_path, config)),
+        env_(ORT_LOGGING_LEVEL_WARNING, "ONNXModel"),
+        session_options_(BuildSessionOptions(config)),
+        session_(env_, model_file_.c_str(), session_options_),
         allocator_(),
-        ready_(0),
+        memory_info_(
+            Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+        io_binding_(session_),
         confidence_threshold_(confidence_threshold),
-        history_size_(history_size),
-        min_consensus_votes_(min_consensus_votes) {
-    /* Retrieve input tensor metadata */
-    size_t num_input_nodes = session_.GetInputCount();
-    std::cout << "Model Input Tensors:\n";
-
-    for (size_t i = 0; i < num_input_nodes; ++i) {
-      auto name = session_.GetInputNameAllocated(i, allocator_);
-      input_names_.push_back(name.get());
-      input_names_cstr_.push_back(input_names_.back().c_str());
-
-      Ort::TypeInfo input_type_info = session_.GetInputTypeInfo(i);
-      auto input_tensor_info = input_type_info.GetTensorTypeAndShapeInfo();
-      input_shape_ = input_tensor_info.GetShape();
-
-      /* Handle dynamic batch dimension */
-      if (input_shape_[0] == -1) {
-        input_shape_[0] = 1;
+        min_consensus_votes_(min_consensus_votes),
+        early_margin_(config.early_margin) {
+    /* A streaming export whose state inputs and outputs do not pair up
+     * cannot be bound; run the window model instead */
+    if (!ReadModelInterface()) {
+      InferenceConfig window_config = config_;
+      window_config.prefer_streaming_model = false;
+      std::string window_file = ResolveModelPath(model_path, window_config);
+      if (window_file == model_file_) {
+        throw std::runtime_error("Unusable model: " + model_file_);
+      }
+      std::cerr << std::format("Falling back to the window model: {}\n",
+                               window_file);
+      model_file_ = window_file;
+      io_binding_ = Ort::IoBinding(nullptr); /* Release before its session */
+      session_ = Ort::Session(env_, model_file_.c_str(), session_options_);
+      io_binding_ = Ort::IoBinding(session_);
+      if (!ReadModelInterface()) {
+        throw std::runtime_error("Unusable model: " + model_file_);
       }
-
-      std::cout << "  Name: " << name.get() << "\n  Shape: ["
-                << VectorToString(input_shape_) << "]\n";
-
-      input_tensor_size_ =
-          std::accumulate(input_shape_.begin(), input_shape_.end(), 1,
-                          std::multiplies<int64_t>());
     }
 
-    /* Retrieve output tensor metadata */
-    size_t num_output_nodes = session_.GetOutputCount();
-    for (size_t i = 0; i < num_output_nodes; ++i) {
-      output_names_.push_back(
-          session_.GetOutputNameAllocated(i, allocator_).get());
-      output_names_cstr_.push_back(output_names_.back().c_str());
-
-      Ort::TypeInfo output_type_info = session_.GetOutputTypeInfo(i);
-      auto output_tensor_info = output_type_info.GetTensorTypeAndShapeInfo();
-      output_shape_ = output_tensor_info.GetShape();
+    /* Bind a persistent output buffer once; only the input is rebound */
+    if (output_shape_[0] == -1) {
+      output_shape_[0] = 1;
+    }
+    output_buffer_.resize(
+        std::accumulate(output_shape_.begin(), output_shape_.end(), 1,
+                        std::multiplies<int64_t>()));
+    output_tensor_ = Ort::Value::CreateTensor<float>(
+        memory_info_, output_buffer_.data(), output_buffer_.size(),
+        output_shape_.data(), output_shape_.size());
+    io_binding_.BindOutput(output_names_cstr_[0], output_tensor_);
 
-      std::cout << "Model Output Tensor:\n  Name: " << output_names_.back()
-                << "\n  Shape: [" << VectorToString(output_shape_) << "]\n";
+    /* States are bound in place too; Forward() copies out to in */
+    for (size_t i = 0; i < stream_states_.size(); ++i) {
+      StreamState& state = stream_states_[i];
+      state.in_tensor = Ort::Value::CreateTensor<float>(
+          memory_info_, state.in.data(), state.in.size(), state.shape.data(),
+          state.shape.size());
+      state.out_tensor = Ort::Value::CreateTensor<float>(
+          memory_info_, state.out.data(), state.out.size(),
+          state.shape.data(), state.shape.size());
+      io_binding_.BindInput(input_names_cstr_[i + 1], state.in_tensor);
+      io_binding_.BindOutput(output_names_cstr_[i + 1], state.out_tensor);
     }
 
-    /* Configure data collection parameters */
-    new_data_number_ =
-        static_cast<int>(static_cast<float>(input_shape_[1]) * update_ratio);
+    /* Configure data collection parameters. A streaming model runs once
+     * per chunk; a window model every update_ratio of the window. */
+    if (IsStreaming()) {
+      new_data_number_ = static_cast<int>(input_shape_[1]) - 1;
+      std::cout << std::format("Streaming model: {} samples per run, {} "
+                               "state tensors\n",
+                               input_shape_[1], stream_states_.size());
+    } else {
+      new_data_number_ =
+          static_cast<int>(static_cast<float>(input_shape_[1]) * update_ratio);
+    }
+    sensor_buffer_.Init(input_tensor_size_);
+    history_.assign(history_size > 0 ? history_size : 1,
+                    ModelOutput::UNRECOGNIZED);
+    motion_gate_.Init(config_.motion_gate_window > 0
+                          ? config_.motion_gate_window
+                          : static_cast<size_t>(input_shape_[1]),
+                      config_.gate_gyro_energy, config_.gate_accel_variance);
 
-    std::cout << std::format("Model initialized: {}\n\n", model_path);
+    std::cout << std::format("Model initialized: {}\n\n", model_file_);
 
     /* Start inference thread */
-    inference_thread_ = std::thread(&InferenceEngine::InferenceTask, this);
+    if (config_.start_thread) {
+      inference_thread_ = std::thread(&InferenceEngine::InferenceTask, this);
+    }
   }
 
+  /**
+   * @brief Record the next `duration` model input samples.
+   *
+   * Samples are taken from the inference thread into a DataRecorder and
+   * written to <prefix>_record_<date>_<time>.bin; convert with
+   * `FluxSandRecordConvert --model`. Blocks until all samples are written.
+   */
   void RecordData(int duration, const char* prefix) {
     /* Generate timestamped filename */
     auto t = std::time(nullptr);
     std::tm tm = *std::localtime(&t);
     std::string filename =
-        std::format("{}_record_{:04}{:02}{:02}_{:02}{:02}{:02}.csv", prefix,
+        std::format("{}_record_{:04}{:02}{:02}_{:02}{:02}{:02}.bin", prefix,
                     tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
                     tm.tm_min, tm.tm_sec);
 
-    /* Create data file */
-    std::ofstream file(filename);
-    if (!file.is_open()) {
+    if (!recorder_.Start(filename)) {
       std::cerr << std::format("Failed to create: {}\n", filename);
       return;
     }
 
-    /* Write CSV header */
-    file << "Pitch,Roll,Gyro_X,Gyro_Y,Gyro_Z,Accel_X,Accel_Y,Accel_Z\n";
-
-    /* Collect data at 1kHz */
-    constexpr std::chrono::microseconds RUN_CYCLE(1000);
-    auto next_sample = std::chrono::steady_clock::now();
-
-    for (int i = 0; i < duration; ++i) {
-      file << std::format("{},{},{},{},{},{},{},{}\n", eulr_.pit.Value(),
-                          eulr_.rol.Value(), gyro_.x, gyro_.y, gyro_.z,
-                          accel_.x, accel_.y, accel_.z);
-
-      next_sample += RUN_CYCLE;
-      std::this_thread::sleep_until(next_sample);
+    record_remaining_.store(duration, std::memory_order_release);
+    for (int left; (left = record_remaining_.load(std::memory_order_acquire)) >
+                   0;) {
+      record_remaining_.wait(left, std::memory_order_acquire);
     }
 
-    file.close();
-    std::cout << std::format("Recorded {} samples to {}\n", duration, filename);
+    recorder_.Stop();
+    std::cout << std::format(
+        "Recorded {} samples to {} ({} dropped, {} failed)\n",
+        recorder_.Written(), filename, recorder_.Dropped(),
+        recorder_.Failed());
   }
 
   /* Main inference processing loop */
   void InferenceTask() {
-    int update_counter = 0;
+    ThreadConfig::Apply(ThreadConfig::Role::INFERENCE);
+    ModelOutput last_result = ModelOutput::UNRECOGNIZED;
 
     while (true) {
-      ready_.acquire();
-
-      /* Update sensor buffer */
-      CollectSensorData();
-
-      if (update_counter++ >= new_data_number_) {
-        update_counter = 0;
-
-        if (sensor_buffer_.size() >= input_tensor_size_) {
-          std::vector<float> input_data(
-              sensor_buffer_.begin(),
-              sensor_buffer_.begin() + static_cast<int>(input_tensor_size_));
-          static ModelOutput last_result = ModelOutput::UNRECOGNIZED;
-          ModelOutput result = RunInference(input_data);
-          if (last_result != result && result != ModelOutput::UNRECOGNIZED) {
-            last_result = result;
+      samples_.Wait();
+
+      /* Catch up on every queued sample, running the model as often as the
+       * window stride requires */
+      size_t count;
+      while ((count = samples_.Pop(batch_.data(), batch_.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+          InferenceResult result;
+          if (!ProcessSample(batch_[i], result)) {
+            continue;
+          }
+          if (last_result != result.gesture &&
+              result.gesture != ModelOutput::UNRECOGNIZED) {
+            last_result = result.gesture;
             if (data_callback_) {
+              ScopedLatency latency(Metrics::Stage::GESTURE_CALLBACK);
               data_callback_(result);
             }
           }
@@ -192,127 +402,693 @@ class InferenceEngine {
     }
   }
 
-  void OnData(const Type::Vector3& accel, const Type::Vector3& gyro,
-              const Type::Eulr& eulr) {
-    accel_ = accel;
-    gyro_ = gyro;
-    eulr_ = eulr;
-    ready_.release();
+  /* Latency, memory and accuracy of one model over a set of recordings */
+  struct BenchmarkReport {
+    std::string model;
+    uintmax_t file_bytes = 0;  /* Model file size */
+    long rss_kb = 0;           /* Resident memory added since construction */
+    size_t runs = 0;           /* Model runs, gated steps excluded */
+    float p50_ms = 0.0f;       /* Median step latency */
+    float p99_ms = 0.0f;       /* 99th percentile step latency */
+    size_t steps = 0;          /* Classification steps on labelled data */
+    size_t correct = 0;        /* Steps whose top-1 matched the label */
+    size_t recordings = 0;     /* Labelled recordings */
+    size_t detected = 0;       /* Recordings whose label won the vote */
+  };
+
+  /**
+   * @brief Replays recorded gestures through this engine's full pipeline.
+   *
+   * Each recording is a CSV in the RecordData layout ("Pitch,Roll,Gyro_X,
+   * Gyro_Y,Gyro_Z,Accel_X,Accel_Y,Accel_Z", as written by
+   * `FluxSandRecordConvert --model`). The expected gesture comes from an
+   * optional ninth "Label" column or else from the file name prefix, e.g.
+   * "tilt_left_record_20250101_120000.csv". Construct the engine with
+   * InferenceConfig::start_thread off so nothing else feeds it.
+   */
+  BenchmarkReport Replay(const std::vector<std::string>& recordings) {
+    BenchmarkReport report;
+    report.model = model_file_;
+    std::error_code ec;
+    report.file_bytes = std::filesystem::file_size(model_file_, ec);
+
+    std::vector<float> timings_ms;
+    std::vector<Type::AttitudeSample> samples;
+    for (const auto& path : recordings) {
+      ModelOutput label = ModelOutput::UNRECOGNIZED;
+      if (!LoadRecording(path, samples, label)) {
+        std::cerr << std::format("Skipping unreadable recording: {}\n", path);
+        continue;
+      }
+
+      /* Every recording starts from a fresh pipeline */
+      sensor_buffer_.Clear();
+      motion_gate_.Clear();
+      ClearVotes();
+      ResetStreamState();
+      update_counter_ = 0;
+
+      bool detected = false;
+      for (const auto& sample : samples) {
+        const uint64_t EXECUTED = GetExecutedRuns();
+        InferenceResult result;
+        auto t_start = std::chrono::steady_clock::now();
+        bool stepped = ProcessSample(sample, result);
+        auto t_end = std::chrono::steady_clock::now();
+        if (!stepped) {
+          continue;
+        }
+        if (GetExecutedRuns() != EXECUTED) {
+          timings_ms.push_back(
+              std::chrono::duration<float, std::milli>(t_end - t_start)
+                  .count());
+        }
+        if (label != ModelOutput::UNRECOGNIZED) {
+          report.steps++;
+          report.correct += (result.top[0].label == label);
+          detected |= (result.gesture == label);
+        }
+      }
+      if (label != ModelOutput::UNRECOGNIZED) {
+        report.recordings++;
+        report.detected += detected;
+      }
+    }
+
+    report.runs = timings_ms.size();
+    if (!timings_ms.empty()) {
+      std::sort(timings_ms.begin(), timings_ms.end());
+      report.p50_ms = timings_ms[timings_ms.size() / 2];
+      report.p99_ms = timings_ms[std::min(timings_ms.size() - 1,
+                                          timings_ms.size() * 99 / 100)];
+    }
+    report.rss_kb = ResidentKb() - construct_rss_kb_;
+    return report;
+  }
+
+  static void PrintReport(const BenchmarkReport& report) {
+    std::cout << std::format("\n[Benchmark: {}]\n", report.model);
+    std::cout << std::format("  Model size    : {} KiB\n",
+                             report.file_bytes / 1024);
+    std::cout << std::format("  Memory (RSS)  : {} KiB\n", report.rss_kb);
+    std::cout << std::format("  Model runs    : {}\n", report.runs);
+    std::cout << std::format("  p50 / p99 (ms): {:.3f} / {:.3f}\n",
+                             report.p50_ms, report.p99_ms);
+    std::cout << std::format(
+        "  Accuracy      : {:.1f}% of {} steps, {} of {} recordings "
+        "detected\n",
+        report.steps ? 100.0 * report.correct / report.steps : 0.0,
+        report.steps, report.detected, report.recordings);
+  }
+
+  /**
+   * @brief Lists the model and its variants next to it.
+   * @return `model_path` followed by every "<model>_*.onnx" (int8,
+   * stream, ...) found in the same directory, sorted by name.
+   */
+  static std::vector<std::string> FindVariants(const std::string& model_path) {
+    std::vector<std::string> variants{model_path};
+    std::filesystem::path path(model_path);
+    const std::string PREFIX = path.stem().string() + "_";
+    std::error_code ec;
+    std::filesystem::path dir =
+        path.has_parent_path() ? path.parent_path() : ".";
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+      const auto& file = entry.path();
+      if (file.extension() == path.extension() &&
+          file.stem().string().starts_with(PREFIX)) {
+        variants.push_back(file.string());
+      }
+    }
+    std::sort(variants.begin() + 1, variants.end());
+    return variants;
+  }
+
+  /**
+   * @brief Feeds one sample through the window, gate, model and vote.
+   *
+   * Runs on the inference thread, or directly from a replay harness when
+   * the engine was built with InferenceConfig::start_thread off.
+   *
+   * @return true if this sample completed a classification step; `result`
+   * is only filled in then.
+   */
+  bool ProcessSample(const Type::AttitudeSample& sample,
+                     InferenceResult& result) {
+    /* Update sensor buffer */
+    CollectSensorData(sample);
+
+    if (update_counter_++ < new_data_number_) {
+      return false;
+    }
+    update_counter_ = 0;
+
+    if (!sensor_buffer_.Full()) {
+      return false;
+    }
+
+    /* Nothing moved over the window: the answer is STILL, skip the model
+     * and feed the vote directly */
+    if (config_.enable_motion_gate && !motion_gate_.Moving()) {
+      skipped_runs_.fetch_add(1, std::memory_order_relaxed);
+      was_gated_ = true;
+      result.top[0] = {ModelOutput::STILL, 1.0f};
+      result.margin = 1.0f;
+      Vote(ModelOutput::STILL, result);
+      return true;
+    }
+
+    if (was_gated_) {
+      /* Cached streaming context predates the idle period */
+      ResetStreamState();
+      was_gated_ = false;
+    }
+    executed_runs_.fetch_add(1, std::memory_order_relaxed);
+    ScopedLatency latency(Metrics::Stage::INFERENCE);
+    result = RunInference(sensor_buffer_.Window());
+    return true;
   }
 
-  void RegisterDataCallback(const std::function<void(ModelOutput)>& callback) {
+  /* Producer side, called from the AHRS thread */
+  void OnData(const Type::ImuSample& sample, const Type::Eulr& eulr) {
+    samples_.Push(Type::AttitudeSample{sample, eulr});
+  }
+
+  /* Samples dropped because inference fell behind */
+  uint64_t GetDroppedSamples() const { return samples_.Dropped(); }
+
+  /* Model runs skipped by the motion gate and actually executed */
+  uint64_t GetSkippedRuns() const {
+    return skipped_runs_.load(std::memory_order_relaxed);
+  }
+  uint64_t GetExecutedRuns() const {
+    return executed_runs_.load(std::memory_order_relaxed);
+  }
+
+  /* True if the loaded model carries its own state between runs */
+  bool IsStreaming() const { return !stream_states_.empty(); }
+
+  void RegisterDataCallback(
+      const std::function<void(const InferenceResult&)>& callback) {
     data_callback_ = callback;
   }
 
+  /* Top-2 margin at which a run is dispatched without waiting for
+   * consensus, see InferenceConfig::early_margin; 0 disables */
+  void SetEarlyMargin(float margin) {
+    early_margin_.store(margin, std::memory_order_relaxed);
+  }
+
+  /* Drives the session and vote state directly, so the engine must be
+   * built with InferenceConfig::start_thread off */
   void RunUnitTest() {
+    if (inference_thread_.joinable()) {
+      std::cerr << "[InferenceEngine::UnitTest] Skipped: inference thread "
+                   "owns the session\n";
+      return;
+    }
     std::cout
         << "[InferenceEngine::UnitTest] Starting inference timing test...\n";
 
-    const int N = 50;  // Number of inference runs
+    const int N = 50;  // Number of inference runs per path
     std::vector<float> dummy_input(input_tensor_size_, 0.0f);  // All zero input
 
-    std::vector<float> timings_ms;
-    timings_ms.reserve(N);
+    /* Time the per-run allocation path first, then the bound buffers */
+    const bool USE_IO_BINDING = config_.use_io_binding;
+    float avg_ms[2] = {};
+
+    for (int pass = 0; pass < 2; ++pass) {
+      config_.use_io_binding = (pass == 1);
+
+      std::vector<float> timings_ms;
+      timings_ms.reserve(N);
+
+      for (int i = 0; i < N; ++i) {
+        auto t_start = std::chrono::high_resolution_clock::now();
+        InferenceResult result = RunInference(dummy_input.data());
+        auto t_end = std::chrono::high_resolution_clock::now();
 
-    for (int i = 0; i < N; ++i) {
-      auto t_start = std::chrono::high_resolution_clock::now();
-      ModelOutput result = RunInference(dummy_input);
-      auto t_end = std::chrono::high_resolution_clock::now();
+        float ms =
+            std::chrono::duration<float, std::milli>(t_end - t_start).count();
+        timings_ms.push_back(ms);
 
-      float ms =
-          std::chrono::duration<float, std::milli>(t_end - t_start).count();
-      timings_ms.push_back(ms);
+        std::cout << std::format(
+            "Run {:02d} → {:>7.3f} ms | Result: {} | Top: {} ({:.2f})\n",
+            i + 1, ms, LabelOf(result.gesture), LabelOf(result.top[0].label),
+            result.top[0].probability);
+      }
+
+      auto [min_it, max_it] =
+          std::minmax_element(timings_ms.begin(), timings_ms.end());
+      avg_ms[pass] =
+          std::accumulate(timings_ms.begin(), timings_ms.end(), 0.0f) / N;
 
-      std::cout << std::format("Run {:02d} → {:>7.3f} ms | Result: {}\n", i + 1,
-                               ms, LABELS.at(result));
+      std::cout << std::format("\n[Inference Timing Summary: {}]\n",
+                               pass == 0 ? "Session::Run" : "IoBinding");
+      std::cout << std::format("  Total Runs    : {}\n", N);
+      std::cout << std::format("  Min Time (ms) : {:>7.3f}\n", *min_it);
+      std::cout << std::format("  Max Time (ms) : {:>7.3f}\n", *max_it);
+      std::cout << std::format("  Avg Time (ms) : {:>7.3f}\n\n", avg_ms[pass]);
     }
 
-    auto [min_it, max_it] =
-        std::minmax_element(timings_ms.begin(), timings_ms.end());
-    float avg = std::accumulate(timings_ms.begin(), timings_ms.end(), 0.0f) / N;
+    config_.use_io_binding = USE_IO_BINDING;
+    ClearVotes();
+    ResetStreamState();
 
-    std::cout << "\n[Inference Timing Summary]\n";
-    std::cout << std::format("  Total Runs    : {}\n", N);
-    std::cout << std::format("  Min Time (ms) : {:>7.3f}\n", *min_it);
-    std::cout << std::format("  Max Time (ms) : {:>7.3f}\n", *max_it);
-    std::cout << std::format("  Avg Time (ms) : {:>7.3f}\n", avg);
+    std::cout << std::format("  IoBinding speedup: {:.2f}x\n",
+                             avg_ms[1] > 0.0f ? avg_ms[0] / avg_ms[1] : 0.0f);
+
+    /* Motion gate: resting noise stays closed, a slow rotation opens it */
+    MotionGate gate;
+    gate.Init(100, config_.gate_gyro_energy, config_.gate_accel_variance);
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+    for (int i = 0; i < 100; ++i) {
+      gate.Push({noise(rng), noise(rng), noise(rng)},
+                {noise(rng), noise(rng), 1.0f + noise(rng)});
+    }
+    bool still_closed = !gate.Moving();
+    for (int i = 0; i < 100; ++i) {
+      gate.Push({0.0f, 0.0f, 0.5f}, {noise(rng), noise(rng), 1.0f});
+    }
+    bool rotation_open = gate.Moving();
+    std::cout << std::format("[Test] Motion gate → {}\n",
+                             still_closed && rotation_open
+                                 ? "✅ Closed at rest, open in motion"
+                                 : "❌ Wrong state");
     std::cout << "[InferenceEngine::UnitTest] ✅ Timing test complete.\n";
   }
 
  private:
+  /* Loads a RecordData CSV as samples, see Replay() */
+  static bool LoadRecording(const std::string& path,
+                            std::vector<Type::AttitudeSample>& samples,
+                            ModelOutput& label) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line)) {
+      return false;
+    }
+
+    const std::string STEM = std::filesystem::path(path).stem().string();
+    label = LabelFromName(STEM.substr(0, STEM.find("_record")));
+
+    samples.clear();
+    uint64_t timestamp_us = 0;
+    while (std::getline(file, line)) {
+      std::stringstream row(line);
+      std::string cell;
+      float values[8];
+      size_t column = 0;
+      while (column < std::size(values) && std::getline(row, cell, ',')) {
+        values[column++] = std::strtof(cell.c_str(), nullptr);
+      }
+      if (column < std::size(values)) {
+        continue;
+      }
+      if (std::getline(row, cell, ',') && !cell.empty()) {
+        ModelOutput row_label = LabelFromName(cell);
+        if (row_label == ModelOutput::UNRECOGNIZED &&
+            std::isdigit(static_cast<unsigned char>(cell[0]))) {
+          row_label = static_cast<ModelOutput>(std::stoi(cell));
+        }
+        label = row_label;
+      }
+
+      Type::AttitudeSample sample{};
+      sample.eulr.pit = Type::CycleValue(values[0]);
+      sample.eulr.rol = Type::CycleValue(values[1]);
+      sample.imu.gyro = {values[2], values[3], values[4]};
+      sample.imu.accel = {values[5], values[6], values[7]};
+      sample.imu.timestamp_us = timestamp_us;
+      timestamp_us += 1000; /* Recorded at 1 kHz */
+      samples.push_back(sample);
+    }
+    return !samples.empty();
+  }
+
+  /* "tilt_left", "Tilt Left" or "tilt-left" → TILT_LEFT */
+  static ModelOutput LabelFromName(std::string name) {
+    for (auto& c : name) {
+      c = (c == '_' || c == '-')
+              ? ' '
+              : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    for (size_t i = 1; i < LABELS.size(); ++i) {
+      std::string label(LABELS[i]);
+      for (auto& c : label) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      }
+      if (label == name) {
+        return static_cast<ModelOutput>(static_cast<int>(i) - 1);
+      }
+    }
+    return ModelOutput::UNRECOGNIZED;
+  }
+
+  /* Resident set size of this process from /proc/self/status */
+  static long ResidentKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+      if (line.starts_with("VmRSS:")) {
+        return std::strtol(line.c_str() + 6, nullptr, 10);
+      }
+    }
+    return 0;
+  }
+
   /* Sensor data collection */
-  void CollectSensorData() {
-    /* Normalize and store sensor readings */
-    sensor_buffer_.push_back(eulr_.pit.Value());
-    sensor_buffer_.push_back(eulr_.rol.Value());
-    sensor_buffer_.push_back(gyro_.x);
-    sensor_buffer_.push_back(gyro_.y);
-    sensor_buffer_.push_back(gyro_.z);
-    sensor_buffer_.push_back(accel_.x / GRAVITY);
-    sensor_buffer_.push_back(accel_.y / GRAVITY);
-    sensor_buffer_.push_back(accel_.z / GRAVITY);
-
-    /* Maintain fixed buffer size */
-    while (sensor_buffer_.size() > input_tensor_size_) {
-      sensor_buffer_.pop_front();
+  void CollectSensorData(const Type::AttitudeSample& sample) {
+    accel_ = sample.imu.accel;
+    gyro_ = sample.imu.gyro;
+    eulr_ = sample.eulr;
+
+    /* Normalize and store sensor readings; the oldest sample drops out */
+    const float SAMPLE[] = {
+        eulr_.pit.Value(),  eulr_.rol.Value(),  gyro_.x, gyro_.y, gyro_.z,
+        accel_.x / GRAVITY, accel_.y / GRAVITY, accel_.z / GRAVITY};
+    sensor_buffer_.Push(SAMPLE, std::size(SAMPLE));
+    motion_gate_.Push(gyro_, {SAMPLE[5], SAMPLE[6], SAMPLE[7]});
+
+    if (record_remaining_.load(std::memory_order_relaxed) > 0) {
+      recorder_.Push(DataRecord{
+          sample.imu.timestamp_us,
+          {accel_.x, accel_.y, accel_.z},
+          {gyro_.x, gyro_.y, gyro_.z},
+          {},
+          {eulr_.rol.Value(), eulr_.pit.Value(), eulr_.yaw.Value()},
+          0});
+      if (record_remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        record_remaining_.notify_all();
+      }
     }
   }
 
   /**
    * @brief Runs inference on the collected sensor data.
-   * @param input_data Vector containing preprocessed sensor data.
-   * @return The predicted motion category as a string label.
+   * @param input_data input_tensor_size_ contiguous preprocessed values; the
+   * tensor is created over this memory without copying.
+   * @return The ranking of this run and the category to act on.
    */
-  ModelOutput RunInference(std::vector<float>& input_data) {
+  InferenceResult RunInference(float* input_data) {
     /* Validate output tensor dimensions */
     if (output_shape_.size() < 2 || output_shape_[1] <= 0) {
       std::perror("Invalid model output dimensions");
     }
 
-    /* Prepare input tensor */
-    Ort::MemoryInfo memory_info =
-        Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    /* Keep the TOP_K most probable classes, best first */
+    const float* probs = Forward(input_data);
+    const size_t CLASSES =
+        std::min(static_cast<size_t>(output_shape_[1]), MODEL_CLASSES);
+    InferenceResult result;
+    for (size_t c = 0; c < CLASSES; ++c) {
+      InferenceResult::Candidate candidate{static_cast<ModelOutput>(c),
+                                           probs[c]};
+      for (auto& slot : result.top) {
+        if (candidate.probability > slot.probability ||
+            slot.label == ModelOutput::UNRECOGNIZED) {
+          std::swap(candidate, slot);
+        }
+      }
+    }
+    result.margin = result.top[0].probability - result.top[1].probability;
+
+    /* Apply confidence threshold */
+    ModelOutput prediction = result.top[0].label;
+    if (result.top[0].probability < confidence_threshold_) {
+      prediction = ModelOutput::UNRECOGNIZED;
+    }
+
+    /* Every run votes once, so the history is what the model said */
+    Vote(prediction, result);
+    const ModelOutput CONSENSUS = result.gesture;
+
+    /* A consensus overtaken by an early dispatch is not reported again
+     * while it lingers in the history */
+    if (overtaken_ != ModelOutput::UNRECOGNIZED) {
+      if (CONSENSUS == overtaken_) {
+        result.gesture = ModelOutput::UNRECOGNIZED;
+      } else {
+        overtaken_ = ModelOutput::UNRECOGNIZED;
+      }
+    }
+
+    /* A clear winner is acted on before consensus accumulates; the
+     * inference thread dispatches a gesture once per change, so the vote
+     * catching up later does not fire it again */
+    const float EARLY_MARGIN = early_margin_.load(std::memory_order_relaxed);
+    if (EARLY_MARGIN > 0.0f && prediction != ModelOutput::UNRECOGNIZED &&
+        result.margin >= EARLY_MARGIN && CONSENSUS != prediction) {
+      overtaken_ = CONSENSUS;
+      result.gesture = prediction;
+      result.votes = votes_[LabelIndex(prediction)];
+      result.early = true;
+    }
+    return result;
+  }
+
+  /**
+   * @brief Adds one prediction to the history and votes over it.
+   *
+   * The histogram is updated as the history window slides, so this costs
+   * an add, a remove and a scan over the fixed label array.
+   * @param result Receives the consensus category and its votes.
+   */
+  void Vote(ModelOutput prediction, InferenceResult& result) {
+    /* Update prediction history; the oldest prediction drops out */
+    if (history_count_ == history_.size()) {
+      votes_[LabelIndex(history_[history_head_])]--;
+    } else {
+      history_count_++;
+    }
+    history_[history_head_] = prediction;
+    votes_[LabelIndex(prediction)]++;
+    if (++history_head_ == history_.size()) {
+      history_head_ = 0;
+    }
+
+    /* Majority vote; ties go to the lowest label like the old map order */
+    size_t best = 0;
+    for (size_t i = 1; i < votes_.size(); ++i) {
+      if (votes_[i] > votes_[best]) {
+        best = i;
+      }
+    }
+
+    /* Report the category only if consensus is reached */
+    result.votes = votes_[best];
+    result.gesture = (votes_[best] >= min_consensus_votes_)
+                         ? static_cast<ModelOutput>(static_cast<int>(best) - 1)
+                         : ModelOutput::UNRECOGNIZED;
+  }
+
+  void ClearVotes() {
+    votes_.fill(0);
+    overtaken_ = ModelOutput::UNRECOGNIZED;
+    history_head_ = 0;
+    history_count_ = 0;
+  }
+
+  /**
+   * @brief Runs the model once over `input_data`.
+   * @return Output probabilities, valid until the next call.
+   */
+  const float* Forward(float* input_data) {
+    /* Prepare input tensor over the caller's memory */
     Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-        memory_info, input_data.data(), input_data.size(), input_shape_.data(),
+        memory_info_, input_data, input_tensor_size_, input_shape_.data(),
         input_shape_.size());
 
-    /* Perform inference */
-    auto outputs =
-        session_.Run(Ort::RunOptions{nullptr}, input_names_cstr_.data(),
-                     &input_tensor, 1, output_names_cstr_.data(), 1);
+    if (config_.use_io_binding) {
+      /* Outputs land in output_buffer_, nothing is allocated per run */
+      io_binding_.BindInput(input_names_cstr_[0], input_tensor);
+      session_.Run(Ort::RunOptions{nullptr}, io_binding_);
+      for (auto& state : stream_states_) {
+        std::copy(state.out.begin(), state.out.end(), state.in.begin());
+      }
+      return output_buffer_.data();
+    }
 
-    /* Get the class with the highest probability */
-    float* probs = outputs.front().GetTensorMutableData<float>();
-    auto max_prob = std::max_element(probs, probs + output_shape_[1]);
-    int pred_class = static_cast<int>(max_prob - probs);
+    if (!IsStreaming()) {
+      outputs_ =
+          session_.Run(Ort::RunOptions{nullptr}, input_names_cstr_.data(),
+                       &input_tensor, 1, output_names_cstr_.data(), 1);
+      return outputs_.front().GetTensorMutableData<float>();
+    }
 
-    /* Apply confidence threshold */
-    if (*max_prob < confidence_threshold_) {
-      pred_class = static_cast<int>(ModelOutput::UNRECOGNIZED);
+    /* Streaming model: feed the cached states and keep the new ones */
+    std::vector<Ort::Value> inputs;
+    inputs.reserve(stream_states_.size() + 1);
+    inputs.push_back(std::move(input_tensor));
+    for (auto& state : stream_states_) {
+      inputs.push_back(Ort::Value::CreateTensor<float>(
+          memory_info_, state.in.data(), state.in.size(), state.shape.data(),
+          state.shape.size()));
+    }
+    outputs_ = session_.Run(Ort::RunOptions{nullptr}, input_names_cstr_.data(),
+                            inputs.data(), inputs.size(),
+                            output_names_cstr_.data(), inputs.size());
+    for (size_t i = 0; i < stream_states_.size(); ++i) {
+      const float* next = outputs_[i + 1].GetTensorData<float>();
+      std::copy(next, next + stream_states_[i].in.size(),
+                stream_states_[i].in.begin());
+    }
+    return outputs_.front().GetTensorMutableData<float>();
+  }
+
+  /* Forget the streaming context, as if the model had just been loaded */
+  void ResetStreamState() {
+    for (auto& state : stream_states_) {
+      std::fill(state.in.begin(), state.in.end(), 0.0f);
     }
+  }
+
+  /**
+   * @brief Reads the input and output names and shapes of the session.
+   *
+   * @return false if the state outputs do not match the state inputs
+   */
+  bool ReadModelInterface() {
+    input_names_.clear();
+    input_names_cstr_.clear();
+    output_names_.clear();
+    output_names_cstr_.clear();
+    stream_states_.clear();
+
+    /* Retrieve input tensor metadata; input 0 is the sensor data, the
+     * rest are cached states of a streaming model */
+    size_t num_input_nodes = session_.GetInputCount();
+    std::cout << "Model Input Tensors:\n";
 
-    /* Update prediction history */
-    prediction_history_.push_back(static_cast<ModelOutput>(pred_class));
-    if (prediction_history_.size() > history_size_) {
-      prediction_history_.pop_front();
+    stream_states_.reserve(num_input_nodes > 0 ? num_input_nodes - 1 : 0);
+    for (size_t i = 0; i < num_input_nodes; ++i) {
+      auto name = session_.GetInputNameAllocated(i, allocator_);
+      input_names_.push_back(name.get());
+
+      Ort::TypeInfo input_type_info = session_.GetInputTypeInfo(i);
+      auto input_tensor_info = input_type_info.GetTensorTypeAndShapeInfo();
+      std::vector<int64_t> shape = input_tensor_info.GetShape();
+
+      /* Handle dynamic dimensions (batch, streaming chunk, state length) */
+      for (auto& dim : shape) {
+        if (dim == -1) {
+          dim = 1;
+        }
+      }
+
+      std::cout << "  Name: " << name.get() << "\n  Shape: ["
+                << VectorToString(shape) << "]\n";
+
+      if (i == 0) {
+        input_shape_ = shape;
+        input_tensor_size_ =
+            std::accumulate(input_shape_.begin(), input_shape_.end(), 1,
+                            std::multiplies<int64_t>());
+      } else {
+        StreamState& state = stream_states_.emplace_back();
+        state.shape = shape;
+        state.in.assign(std::accumulate(shape.begin(), shape.end(), 1,
+                                        std::multiplies<int64_t>()),
+                        0.0f);
+        state.out.assign(state.in.size(), 0.0f);
+      }
+    }
+    for (const auto& name : input_names_) {
+      input_names_cstr_.push_back(name.c_str());
     }
 
-    /* Perform majority voting to ensure stable predictions */
-    std::map<ModelOutput, int> votes;
-    for (auto label : prediction_history_) {
-      votes[label]++;
+    /* Retrieve output tensor metadata; output 0 is the class
+     * probabilities, output i > 0 the new value of state input i */
+    size_t num_output_nodes = session_.GetOutputCount();
+    for (size_t i = 0; i < num_output_nodes; ++i) {
+      output_names_.push_back(
+          session_.GetOutputNameAllocated(i, allocator_).get());
+
+      Ort::TypeInfo output_type_info = session_.GetOutputTypeInfo(i);
+      auto output_tensor_info = output_type_info.GetTensorTypeAndShapeInfo();
+      std::vector<int64_t> shape = output_tensor_info.GetShape();
+      if (i == 0) {
+        output_shape_ = shape;
+      }
+
+      std::cout << "Model Output Tensor:\n  Name: " << output_names_.back()
+                << "\n  Shape: [" << VectorToString(shape) << "]\n";
+    }
+    for (const auto& name : output_names_) {
+      output_names_cstr_.push_back(name.c_str());
     }
 
-    auto consensus =
-        std::max_element(votes.begin(), votes.end(),
-                         [](auto& a, auto& b) { return a.second < b.second; });
+    if (num_output_nodes != stream_states_.size() + 1) {
+      std::cerr << std::format(
+          "Model has {} state inputs but {} state outputs\n",
+          stream_states_.size(), num_output_nodes - 1);
+      return false;
+    }
+    return true;
+  }
 
-    /* Return the final motion category if consensus is reached */
-    ModelOutput result = (consensus->second >= min_consensus_votes_)
-                             ? consensus->first
-                             : ModelOutput::UNRECOGNIZED;
+  /* Translate InferenceConfig into ORT session options */
+  static Ort::SessionOptions BuildSessionOptions(
+      const InferenceConfig& config) {
+    Ort::SessionOptions options;
+    options.SetGraphOptimizationLevel(config.optimization_level);
+    /* Keep the pool off the core reserved for IMU sampling and fusion */
+    const int GENERAL_CORES = ThreadConfig::GeneralCoreCount();
+    options.SetIntraOpNumThreads(
+        config.intra_op_threads > 0
+            ? std::min(config.intra_op_threads, GENERAL_CORES)
+            : GENERAL_CORES);
+    options.SetInterOpNumThreads(config.inter_op_threads);
+    options.SetExecutionMode(config.inter_op_threads > 1 ? ORT_PARALLEL
+                                                         : ORT_SEQUENTIAL);
+    if (config.enable_mem_pattern) {
+      options.EnableMemPattern();
+    } else {
+      options.DisableMemPattern();
+    }
+    options.AddConfigEntry("session.intra_op.allow_spinning",
+                           config.allow_spinning ? "1" : "0");
+    options.AddConfigEntry("session.inter_op.allow_spinning",
+                           config.allow_spinning ? "1" : "0");
+    return options;
+  }
 
-    return result;
+  /* Apply the configured variant ("<model>_int8.onnx"), then prefer
+   * "<model>_stream.onnx" (streaming export) and "<model>.ort" (already
+   * optimized, faster to load) if they exist */
+  static std::string ResolveModelPath(const std::string& model_path,
+                                      const InferenceConfig& config) {
+    std::error_code ec;
+    std::filesystem::path path(model_path);
+    if (!config.variant.empty()) {
+      std::filesystem::path variant_path = path;
+      variant_path.replace_filename(path.stem().string() + "_" +
+                                    config.variant + path.extension().string());
+      if (std::filesystem::exists(variant_path, ec)) {
+        path = variant_path;
+      } else {
+        std::cerr << std::format("Model variant not found, using {}: {}\n",
+                                 model_path, variant_path.string());
+      }
+    }
+    if (config.prefer_streaming_model) {
+      std::filesystem::path stream_path = path;
+      stream_path.replace_filename(path.stem().string() + "_stream" +
+                                   path.extension().string());
+      if (std::filesystem::exists(stream_path, ec)) {
+        path = stream_path;
+      }
+    }
+    if (!config.prefer_ort_model) {
+      return path.string();
+    }
+    std::filesystem::path ort_path = path;
+    ort_path.replace_extension(".ort");
+    if (ort_path != path && std::filesystem::exists(ort_path, ec)) {
+      return ort_path.string();
+    }
+    return path.string();
   }
 
   /* Helper to format vector for logging */
@@ -325,11 +1101,20 @@ class InferenceEngine {
     return ss.str();
   }
 
+  /* Resident memory before the session was created, for Replay() */
+  long construct_rss_kb_ = ResidentKb();
+
+  /* Session settings and the model file actually loaded */
+  InferenceConfig config_;
+  std::string model_file_;
+
   /* ONNX runtime components */
   Ort::Env env_;
   Ort::SessionOptions session_options_;
   Ort::Session session_;
   Ort::AllocatorWithDefaultOptions allocator_;
+  Ort::MemoryInfo memory_info_;
+  Ort::IoBinding io_binding_;
 
   /* Model interface metadata */
   std::vector<std::string> input_names_;
@@ -341,16 +1126,42 @@ class InferenceEngine {
   std::vector<const char*> output_names_cstr_;
   std::vector<int64_t> output_shape_;
 
+  /* Cached state of a streaming model, one per state input/output pair */
+  struct StreamState {
+    std::vector<int64_t> shape;
+    std::vector<float> in;           /* Fed to the next run */
+    std::vector<float> out;          /* Written by the bound run */
+    Ort::Value in_tensor{nullptr};   /* View over in */
+    Ort::Value out_tensor{nullptr};  /* View over out */
+  };
+  std::vector<StreamState> stream_states_;
+
   /* Data buffers */
-  std::deque<float> sensor_buffer_;
-  std::deque<ModelOutput> prediction_history_;
+  MirroredRingBuffer<float> sensor_buffer_;
+  std::vector<float> output_buffer_;  /* Bound output storage */
+  Ort::Value output_tensor_{nullptr}; /* View over output_buffer_ */
+  std::vector<Ort::Value> outputs_;   /* Session::Run path results */
+
+  /* Prediction history for voting, with a histogram of its contents */
+  std::vector<ModelOutput> history_;
+  size_t history_head_ = 0;  /* Oldest prediction once full */
+  size_t history_count_ = 0; /* Valid predictions */
+  std::array<size_t, MODEL_CLASSES + 1> votes_{};
+  /* Consensus replaced by the last early dispatch, see RunInference() */
+  ModelOutput overtaken_ = ModelOutput::UNRECOGNIZED;
 
   /* Minimum probability required to accept a prediction */
   float confidence_threshold_;
-  /* Number of past predictions stored for voting */
-  size_t history_size_;
   /* Minimum votes required to confirm a prediction */
   size_t min_consensus_votes_;
+  /* Margin for an early dispatch, read by the inference thread */
+  std::atomic<float> early_margin_;
+
+  /* Pre-filter skipping the model while nothing moves */
+  MotionGate motion_gate_;
+  bool was_gated_ = false;
+  std::atomic<uint64_t> skipped_runs_{0};
+  std::atomic<uint64_t> executed_runs_{0};
 
   /* Sensor state */
   Type::Eulr eulr_{};
@@ -358,10 +1169,18 @@ class InferenceEngine {
   Type::Vector3 accel_{};
 
   /* Callback function */
-  std::function<void(ModelOutput)> data_callback_;
+  std::function<void(const InferenceResult&)> data_callback_;
+
+  /* Sample pipeline from the AHRS, drained in batches */
+  SpscRing<Type::AttitudeSample, 1024> samples_;
+  std::array<Type::AttitudeSample, 64> batch_{};
+
+  /* Dataset recording for RecordData() */
+  DataRecorder recorder_;
+  std::atomic<int> record_remaining_{0};
 
   /* Thread control */
-  std::binary_semaphore ready_;
   std::thread inference_thread_;
   int new_data_number_;
+  int update_counter_ = 0; /* Samples since the last classification step */
 };
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "comp_timer.hpp"
+
+/**
+ * @brief Lock-free log-linear latency histogram.
+ *
+ * Each power-of-two range of nanoseconds is split into SUB_BUCKETS linear
+ * buckets, so a recorded value is known to within 1/SUB_BUCKETS of itself
+ * from 1 ns up to several seconds in a couple of kilobytes. Record() is a
+ * few relaxed atomic adds and never blocks; readers see a snapshot that may
+ * be a few samples behind.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr unsigned SUB_BITS = 3;
+  static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BITS;
+  static constexpr size_t OCTAVES = 32; /* Exact up to about 8.6 s */
+  static constexpr size_t BUCKETS = OCTAVES * SUB_BUCKETS;
+
+  /// Add one latency sample
+  void Record(std::chrono::nanoseconds latency) {
+    const uint64_t NS =
+        latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+    buckets_[BucketOf(NS)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(NS, std::memory_order_relaxed);
+
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (NS > max && !max_ns_.compare_exchange_weak(
+                           max, NS, std::memory_order_relaxed)) {
+    }
+  }
+
+  /// Add the time elapsed since `start`
+  void RecordSince(std::chrono::steady_clock::time_point start) {
+    Record(std::chrono::steady_clock::now() - start);
+  }
+
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+  std::chrono::nanoseconds Max() const {
+    return std::chrono::nanoseconds(max_ns_.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::nanoseconds Sum() const {
+    return std::chrono::nanoseconds(sum_ns_.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::nanoseconds Mean() const {
+    const uint64_t COUNT = Count();
+    return std::chrono::nanoseconds(
+        COUNT ? sum_ns_.load(std::memory_order_relaxed) / COUNT : 0);
+  }
+
+  /**
+   * @brief Latency below which a fraction `q` of the samples fall.
+   * @return Upper edge of the bucket holding the quantile, capped at Max()
+   */
+  std::chrono::nanoseconds Quantile(double q) const {
+    const uint64_t COUNT = Count();
+    if (COUNT == 0) {
+      return std::chrono::nanoseconds::zero();
+    }
+    const uint64_t RANK = static_cast<uint64_t>(q * static_cast<double>(COUNT));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen > RANK) {
+        return std::min(std::chrono::nanoseconds(LowerBound(i + 1) - 1),
+                        Max());
+      }
+    }
+    return Max();
+  }
+
+  void Reset() {
+    for (auto& bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+  }
+
+  /// Bucket index of a value in nanoseconds
+  static constexpr size_t BucketOf(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+      return static_cast<size_t>(ns);
+    }
+    const unsigned MSB = static_cast<unsigned>(std::bit_width(ns)) - 1;
+    const size_t OCTAVE = MSB - SUB_BITS + 1;
+    if (OCTAVE >= OCTAVES) {
+      return BUCKETS - 1;
+    }
+    const size_t SUB = (ns >> (MSB - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return OCTAVE * SUB_BUCKETS + SUB;
+  }
+
+  /// Smallest value in nanoseconds that falls into bucket `index`
+  static constexpr uint64_t LowerBound(size_t index) {
+    const size_t OCTAVE = index / SUB_BUCKETS;
+    const size_t SUB = index % SUB_BUCKETS;
+    if (OCTAVE == 0) {
+      return SUB;
+    }
+    return static_cast<uint64_t>(SUB_BUCKETS + SUB) << (OCTAVE - 1);
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_ns_{0};
+  std::atomic<uint64_t> max_ns_{0};
+};
+
+/**
+ * @brief Always-on pipeline instrumentation.
+ *
+ * Holds one latency histogram per pipeline stage and a list of named
+ * counters read from the components that own them (dropped samples, FIFO
+ * overflows, missed deadlines). Every stage is recorded by exactly one
+ * thread, so recording costs a handful of uncontended relaxed atomics.
+ *
+ * StartExport() rewrites a plain-text snapshot in the Prometheus text
+ * format every second; under systemd the file lives in the service's
+ * RuntimeDirectory, /run/fluxsand/metrics.
+ */
+class Metrics {
+ public:
+  /** Pipeline stages, in the order a sample flows through them */
+  enum class Stage : uint8_t {
+    IMU_READ,         /* FIFO drain or register read and decode */
+    AHRS_UPDATE,      /* Fusion of one drained batch */
+    INFERENCE,        /* One model run */
+    GESTURE_CALLBACK, /* Gesture handler invocation */
+    RENDER,           /* One main loop frame */
+    SPI_REFRESH,      /* Display refresh job */
+    NUMBER
+  };
+
+  static constexpr std::array<std::string_view,
+                              static_cast<size_t>(Stage::NUMBER)>
+      STAGE_NAMES = {"imu_read",         "ahrs_update", "inference",
+                     "gesture_callback", "render",      "spi_refresh"};
+
+  static constexpr const char* DEFAULT_PATH = "/run/fluxsand/metrics";
+  static constexpr std::chrono::seconds EXPORT_PERIOD{1};
+
+  Metrics() = default;
+  ~Metrics() { StopExport(); }
+
+  Metrics(const Metrics&) = delete;
+  Metrics& operator=(const Metrics&) = delete;
+
+  /// Process-wide instance the components record into
+  static Metrics& Default() {
+    /* Construct the timer service first so it outlives the export job */
+    TimerService::Default();
+    static Metrics metrics;
+    return metrics;
+  }
+
+  LatencyHistogram& Latency(Stage stage) {
+    return latency_[static_cast<size_t>(stage)];
+  }
+
+  /**
+   * @brief Export a counter owned by another component.
+   * @param name Metric name, without the "fluxsand_" prefix
+   * @param read Returns the current value; called from the export job
+   */
+  void AddCounter(const std::string& name, std::function<uint64_t()> read) {
+    std::lock_guard<std::mutex> lock(counters_mutex_);
+    counters_.push_back({name, std::move(read)});
+  }
+
+  /// Snapshot of every stage and counter in the Prometheus text format
+  std::string Format() const {
+    std::string out;
+    out += "# TYPE fluxsand_latency_us summary\n";
+    for (size_t i = 0; i < latency_.size(); ++i) {
+      const LatencyHistogram& histogram = latency_[i];
+      const std::string_view NAME = STAGE_NAMES[i];
+      for (double q : {0.5, 0.9, 0.99}) {
+        out += std::format(
+            "fluxsand_latency_us{{stage=\"{}\",quantile=\"{}\"}} {:.1f}\n",
+            NAME, q, ToUs(histogram.Quantile(q)));
+      }
+      out += std::format("fluxsand_latency_us_sum{{stage=\"{}\"}} {:.1f}\n",
+                         NAME, ToUs(histogram.Sum()));
+      out += std::format("fluxsand_latency_us_count{{stage=\"{}\"}} {}\n",
+                         NAME, histogram.Count());
+    }
+
+    /* Max and mean are not part of a summary, so each is its own gauge */
+    out += "# TYPE fluxsand_latency_max_us gauge\n";
+    for (size_t i = 0; i < latency_.size(); ++i) {
+      out += std::format("fluxsand_latency_max_us{{stage=\"{}\"}} {:.1f}\n",
+                         STAGE_NAMES[i], ToUs(latency_[i].Max()));
+    }
+    out += "# TYPE fluxsand_latency_mean_us gauge\n";
+    for (size_t i = 0; i < latency_.size(); ++i) {
+      out += std::format("fluxsand_latency_mean_us{{stage=\"{}\"}} {:.1f}\n",
+                         STAGE_NAMES[i], ToUs(latency_[i].Mean()));
+    }
+
+    std::lock_guard<std::mutex> lock(counters_mutex_);
+    for (const auto& counter : counters_) {
+      out += std::format("# TYPE fluxsand_{} counter\n", counter.name);
+      out += std::format("fluxsand_{} {}\n", counter.name, counter.read());
+    }
+    return out;
+  }
+
+  /**
+   * @brief Write a snapshot to `path`, replacing it atomically.
+   * @return false if the file could not be written
+   */
+  bool WriteFile(const std::string& path) const {
+    const std::string TMP = path + ".tmp";
+    std::FILE* file = std::fopen(TMP.c_str(), "w");
+    if (!file) {
+      return false;
+    }
+    const std::string TEXT = Format();
+    bool ok = std::fwrite(TEXT.data(), 1, TEXT.size(), file) == TEXT.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(TMP.c_str(), path.c_str()) != 0) {
+      unlink(TMP.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Rewrite `path` every EXPORT_PERIOD on the shared timer service.
+   * @return false if the directory is missing or not writable
+   */
+  bool StartExport(const std::string& path = DEFAULT_PATH) {
+    if (export_timer_ != TimerService::INVALID_TIMER) {
+      return false;
+    }
+    if (!WriteFile(path)) {
+      std::perror(("Metrics export disabled, cannot write " + path).c_str());
+      return false;
+    }
+    export_path_ = path;
+    export_timer_ = TimerService::Default().AddPeriodic(
+        EXPORT_PERIOD, [this]() { WriteFile(export_path_); });
+    return export_timer_ != TimerService::INVALID_TIMER;
+  }
+
+  void StopExport() {
+    if (export_timer_ != TimerService::INVALID_TIMER) {
+      TimerService::Default().Remove(export_timer_);
+      export_timer_ = TimerService::INVALID_TIMER;
+    }
+  }
+
+  void RunUnitTest() {
+    std::cout << "[Metrics::UnitTest] Starting metrics test...\n";
+
+    /* Bucket edges are contiguous and every value lands inside its bucket */
+    bool buckets_ok = true;
+    for (uint64_t ns : {0ull, 7ull, 8ull, 1000ull, 123456ull, 4000000000ull}) {
+      const size_t INDEX = LatencyHistogram::BucketOf(ns);
+      buckets_ok &= LatencyHistogram::LowerBound(INDEX) <= ns &&
+                    ns < LatencyHistogram::LowerBound(INDEX + 1);
+    }
+    std::cout << std::format("[Test] Bucket bounds → {}\n",
+                             buckets_ok ? "✅ Match" : "❌ Mismatch");
+
+    /* 1..1000 us uniformly: quantiles within one sub-bucket */
+    LatencyHistogram histogram;
+    for (int us = 1; us <= 1000; ++us) {
+      histogram.Record(std::chrono::microseconds(us));
+    }
+    const double P50 = ToUs(histogram.Quantile(0.5));
+    const double P99 = ToUs(histogram.Quantile(0.99));
+    const double TOLERANCE = 1.0 / LatencyHistogram::SUB_BUCKETS;
+    bool quantile_ok = P50 >= 500.0 && P50 <= 500.0 * (1.0 + TOLERANCE) &&
+                       P99 >= 990.0 && P99 <= 1000.0 &&
+                       histogram.Max() == std::chrono::microseconds(1000);
+    std::cout << std::format(
+        "[Test] Quantiles → p50 {:.1f} us | p99 {:.1f} us | {}\n", P50, P99,
+        quantile_ok ? "✅ Within bucket" : "❌ Out of range");
+
+    /* Recording cost on the hot path */
+    const int N = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; ++i) {
+      histogram.Record(std::chrono::nanoseconds(i));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << std::format(
+        "[Test] Record → {:.1f} ns per sample\n",
+        std::chrono::duration<double, std::nano>(elapsed).count() / N);
+
+    /* Every sample belongs to the family of the last # TYPE line */
+    bool families_ok = true;
+    std::string family;
+    std::istringstream text(Format());
+    for (std::string line; std::getline(text, line);) {
+      if (line.starts_with("# TYPE ")) {
+        family = line.substr(7, line.find(' ', 7) - 7);
+        continue;
+      }
+      const std::string NAME = line.substr(0, line.find_first_of("{ "));
+      families_ok &= NAME == family || NAME == family + "_sum" ||
+                     NAME == family + "_count";
+    }
+    std::cout << std::format("[Test] Exposition families → {}\n",
+                             families_ok ? "✅ Typed" : "❌ Untyped sample");
+
+    const std::string PATH = "/tmp/fluxsand_metrics_test";
+    bool file_ok = WriteFile(PATH) && std::filesystem::file_size(PATH) > 0;
+    std::cout << std::format("[Test] Export → {}\n",
+                             file_ok ? "✅ Written" : "❌ Failed");
+    unlink(PATH.c_str());
+  }
+
+ private:
+  struct Counter {
+    std::string name;
+    std::function<uint64_t()> read;
+  };
+
+  static double ToUs(std::chrono::nanoseconds ns) {
+    return static_cast<double>(ns.count()) / 1000.0;
+  }
+
+  std::array<LatencyHistogram, static_cast<size_t>(Stage::NUMBER)> latency_;
+
+  mutable std::mutex counters_mutex_; /* Guards counters_, not the hot path */
+  std::vector<Counter> counters_;
+
+  std::string export_path_;
+  TimerService::TimerId export_timer_ = TimerService::INVALID_TIMER;
+};
+
+/**
+ * @brief Records the lifetime of the scope into one pipeline stage.
+ */
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(Metrics::Stage stage)
+      : histogram_(Metrics::Default().Latency(stage)),
+        start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedLatency() { histogram_.RecordSince(start_); }
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+ private:
+  LatencyHistogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "bsp_thread.hpp"
+#include "comp_ring_buffer.hpp"
+
+/**
+ * @brief One dataset sample, written to disk as-is.
+ *
+ * Fixed 64-byte layout so a recording is a header followed by a flat array
+ * of records; unused fields are zero.
+ */
+struct DataRecord {
+  uint64_t timestamp_us;  ///< Sample time (steady clock)
+  float accel[3];         ///< m/s^2
+  float gyro[3];          ///< rad/s, bias removed
+  float quat[4];          ///< q0..q3
+  float eulr[3];          ///< Roll, pitch, yaw in rad
+  int32_t label;          ///< Gesture label of the session
+};
+static_assert(sizeof(DataRecord) == 64, "DataRecord must stay 64 bytes");
+
+/// File header in front of the records, same size as one record
+struct DataRecordHeader {
+  static constexpr std::array<char, 8> MAGIC = {'F', 'S', 'R', 'E',
+                                                'C', 'O', 'R', 'D'};
+  static constexpr uint32_t VERSION = 1;
+
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t start_us;  ///< Steady clock time the session started
+  uint8_t reserved[40];
+};
+static_assert(sizeof(DataRecordHeader) == sizeof(DataRecord),
+              "Header keeps the records 64-byte aligned in the file");
+
+/**
+ * @brief Asynchronous binary recorder for sensor datasets.
+ *
+ * The sampling thread only copies a record into a preallocated lock-free
+ * ring. A writer thread wakes every FLUSH_PERIOD and hands everything queued
+ * to the kernel with a single writev() straight from the ring storage, so a
+ * slow SD card stalls the writer, not the sampler. Records that do not fit
+ * the ring are dropped and counted. Convert recordings to CSV with the
+ * FluxSandRecordConvert tool.
+ */
+class DataRecorder {
+ public:
+  /// Ring capacity, about 16 s at 1 kHz
+  static constexpr size_t CAPACITY = 16384;
+
+  /// Writer wakeup interval; 16 KiB per write at 1 kHz
+  static constexpr std::chrono::milliseconds FLUSH_PERIOD{250};
+
+  DataRecorder() = default;
+  ~DataRecorder() { Stop(); }
+
+  DataRecorder(const DataRecorder&) = delete;
+  DataRecorder& operator=(const DataRecorder&) = delete;
+
+  /**
+   * @brief Open a recording and start the writer thread.
+   * @param path Output file, truncated if it exists
+   * @return false if already recording or the file could not be created
+   */
+  bool Start(const std::string& path) {
+    if (recording_.load(std::memory_order_acquire) || writer_.joinable()) {
+      return false;
+    }
+
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      std::perror(("Failed to create " + path).c_str());
+      return false;
+    }
+
+    if (!ring_) {
+      ring_ = std::make_unique<SpscRing<DataRecord, CAPACITY>>();
+    }
+    /* Discard anything left over from a previous session */
+    auto stale = ring_->Peek();
+    ring_->Consume(stale[0].size() + stale[1].size());
+    dropped_at_start_ = ring_->Dropped();
+    written_ = 0;
+    failed_ = 0;
+
+    DataRecordHeader header{};
+    header.magic = DataRecordHeader::MAGIC;
+    header.version = DataRecordHeader::VERSION;
+    header.record_size = sizeof(DataRecord);
+    header.start_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+    if (!WriteAll(&header, sizeof(header))) {
+      close(fd_);
+      fd_ = -1;
+      return false;
+    }
+
+    recording_.store(true, std::memory_order_release);
+    writer_ = std::thread(&DataRecorder::WriterTask, this);
+    return true;
+  }
+
+  /// Stop recording, write out what is queued and close the file
+  void Stop() {
+    recording_.store(false, std::memory_order_release);
+    if (writer_.joinable()) {
+      writer_.join();
+    }
+    if (fd_ >= 0) {
+      Flush();
+      fdatasync(fd_);
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  /**
+   * @brief Queue one record (single producer, never blocks).
+   * @return false if not recording or the ring was full
+   */
+  bool Push(const DataRecord& record) {
+    if (!recording_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    return ring_->Push(record);
+  }
+
+  bool IsRecording() const {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  /// Records written to the file in the current or last session
+  uint64_t Written() const { return written_.load(std::memory_order_relaxed); }
+
+  /// Records dropped because the writer fell behind in this session
+  uint64_t Dropped() const {
+    return ring_ ? ring_->Dropped() - dropped_at_start_ : 0;
+  }
+
+  /// Records lost to a failed write in this session
+  uint64_t Failed() const { return failed_.load(std::memory_order_relaxed); }
+
+  void RunUnitTest() {
+    std::cout << "[DataRecorder::UnitTest] Starting recorder test...\n";
+
+    const std::string PATH = "/tmp/fluxsand_recorder_test.bin";
+    const int N = 5000;
+    if (!Start(PATH)) {
+      std::cout << "[Test] Start → ❌ Failed\n";
+      return;
+    }
+
+    /* 1 kHz producer, the rate of the IMU stream */
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    std::chrono::nanoseconds max_push{0};
+    for (int i = 0; i < N; ++i) {
+      DataRecord record{};
+      record.timestamp_us = static_cast<uint64_t>(i) * 1000;
+      record.label = i;
+      auto t0 = std::chrono::steady_clock::now();
+      Push(record);
+      max_push = std::max(max_push, std::chrono::steady_clock::now() - t0);
+      next += std::chrono::milliseconds(1);
+      std::this_thread::sleep_until(next);
+    }
+    Stop();
+
+    struct stat st {};
+    bool size_ok =
+        stat(PATH.c_str(), &st) == 0 &&
+        static_cast<uint64_t>(st.st_size) ==
+            sizeof(DataRecordHeader) + (Written() * sizeof(DataRecord));
+    bool count_ok =
+        Written() + Dropped() + Failed() == static_cast<uint64_t>(N);
+
+    std::cout << std::format(
+        "[Test] {} records → written: {} | dropped: {} | failed: {} | "
+        "max push {} ns\n",
+        N, Written(), Dropped(), Failed(), max_push.count());
+    std::cout << std::format("[Test] File size → {}\n",
+                             size_ok && count_ok ? "✅ Match" : "❌ Mismatch");
+    unlink(PATH.c_str());
+  }
+
+ private:
+  void WriterTask() {
+    ThreadConfig::Apply(ThreadConfig::Role::RECORDER);
+    auto next = std::chrono::steady_clock::now();
+    while (recording_.load(std::memory_order_acquire)) {
+      next += FLUSH_PERIOD;
+      std::this_thread::sleep_until(next);
+      Flush();
+    }
+  }
+
+  /* Write both readable ring segments in one syscall */
+  void Flush() {
+    auto segments = ring_->Peek();
+    const size_t COUNT = segments[0].size() + segments[1].size();
+    if (COUNT == 0) {
+      return;
+    }
+
+    std::array<iovec, 2> iov = {{
+        {const_cast<DataRecord*>(segments[0].data()),
+         segments[0].size_bytes()},
+        {const_cast<DataRecord*>(segments[1].data()),
+         segments[1].size_bytes()},
+    }};
+    int iov_count = segments[1].empty() ? 1 : 2;
+    iovec* current = iov.data();
+    size_t total = 0;
+
+    /* writev may stop short; continue from where it left off */
+    while (iov_count > 0) {
+      ssize_t n = writev(fd_, current, iov_count);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        std::perror("DataRecorder write failed");
+        break;
+      }
+      total += static_cast<size_t>(n);
+      size_t left = static_cast<size_t>(n);
+      while (iov_count > 0 && left >= current->iov_len) {
+        left -= current->iov_len;
+        ++current;
+        --iov_count;
+      }
+      if (iov_count > 0) {
+        current->iov_base = static_cast<uint8_t*>(current->iov_base) + left;
+        current->iov_len -= left;
+      }
+    }
+
+    /* Only whole records count; a torn tail is cut off so the file stays
+     * a flat array and the next flush lands on a record boundary */
+    const size_t WHOLE = total / sizeof(DataRecord);
+    const size_t TORN = total % sizeof(DataRecord);
+    if (TORN > 0) {
+      off_t end = lseek(fd_, -static_cast<off_t>(TORN), SEEK_CUR);
+      if (end < 0 || ftruncate(fd_, end) != 0) {
+        std::perror("DataRecorder truncate failed");
+      }
+    }
+
+    ring_->Consume(COUNT);
+    written_.fetch_add(WHOLE, std::memory_order_relaxed);
+    if (WHOLE < COUNT) {
+      failed_.fetch_add(COUNT - WHOLE, std::memory_order_relaxed);
+    }
+  }
+
+  bool WriteAll(const void* data, size_t size) {
+    const uint8_t* ptr = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+      ssize_t n = write(fd_, ptr, size);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        std::perror("DataRecorder write failed");
+        return false;
+      }
+      ptr += n;
+      size -= static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  std::unique_ptr<SpscRing<DataRecord, CAPACITY>> ring_;
+  std::atomic<bool> recording_{false};
+  std::thread writer_;
+  int fd_ = -1;
+  uint64_t dropped_at_start_ = 0;
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> failed_{0};
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+/**
+ * @brief Fixed-capacity ring buffer whose last `capacity` elements are always
+ * contiguous in memory.
+ *
+ * Every element is written twice, at `i` and `i + capacity`, so the window
+ * starting at the oldest element never wraps. Storage is allocated once and
+ * aligned to a cache line, which lets callers hand the window directly to
+ * code that expects a flat array (e.g. an ONNX input tensor).
+ *
+ * @tparam T Trivially copyable element type
+ */
+template <typename T>
+class MirroredRingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "MirroredRingBuffer requires a trivially copyable type");
+
+ public:
+  static constexpr size_t ALIGNMENT = 64;
+
+  MirroredRingBuffer() = default;
+
+  /**
+   * @brief Allocate storage for `capacity` elements and clear the buffer.
+   * @param capacity Window length in elements
+   */
+  void Init(size_t capacity) {
+    assert(capacity > 0);
+    data_.reset(static_cast<T*>(::operator new[](
+        sizeof(T) * capacity * 2, std::align_val_t(ALIGNMENT))));
+    capacity_ = capacity;
+    head_ = 0;
+    size_ = 0;
+  }
+
+  /**
+   * @brief Append elements, dropping the oldest ones once full.
+   * @param values Elements to append
+   * @param count Number of elements (at most the capacity)
+   */
+  void Push(const T* values, size_t count) {
+    assert(data_ && count <= capacity_);
+    for (size_t i = 0; i < count; ++i) {
+      data_[head_] = values[i];
+      data_[head_ + capacity_] = values[i];
+      if (++head_ == capacity_) {
+        head_ = 0;
+      }
+    }
+    size_ = (size_ + count < capacity_) ? size_ + count : capacity_;
+  }
+
+  /// Oldest element; the next Size() elements are contiguous
+  T* Window() { return data_.get() + Start(); }
+  const T* Window() const { return data_.get() + Start(); }
+
+  bool Full() const { return size_ == capacity_; }
+  size_t Size() const { return size_; }
+  size_t Capacity() const { return capacity_; }
+
+  void Clear() {
+    head_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  struct AlignedDelete {
+    void operator()(T* ptr) const {
+      ::operator delete[](ptr, std::align_val_t(ALIGNMENT));
+    }
+  };
+
+  size_t Start() const { return (head_ + capacity_ - size_) % capacity_; }
+
+  std::unique_ptr<T[], AlignedDelete> data_;
+  size_t capacity_ = 0;
+  size_t head_ = 0; /* Next write position */
+  size_t size_ = 0; /* Valid elements */
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring.
+ *
+ * The producer never blocks: when the ring is full the sample is dropped and
+ * counted. The consumer sleeps on a doorbell counter with
+ * std::atomic::wait(), which the producer rings once per Push call; a batch
+ * push therefore costs a single wakeup.
+ *
+ * @tparam T Element type
+ * @tparam N Capacity, must be a power of two
+ */
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+
+ public:
+  static constexpr size_t CAPACITY = N;
+
+  /**
+   * @brief Append one element (producer only).
+   * @return false if the ring was full and the element was dropped
+   */
+  bool Push(const T& value) {
+    bool ok = Write(value);
+    Ring();
+    return ok;
+  }
+
+  /**
+   * @brief Append a batch of elements (producer only).
+   * @return Number of elements stored, the rest were dropped
+   */
+  size_t Push(std::span<const T> values) {
+    size_t stored = 0;
+    for (const T& value : values) {
+      if (!Write(value)) {
+        dropped_.fetch_add(values.size() - stored - 1,
+                           std::memory_order_relaxed);
+        break;
+      }
+      ++stored;
+    }
+    Ring();
+    return stored;
+  }
+
+  /**
+   * @brief Move up to `max` of the oldest elements out (consumer only).
+   * @return Number of elements copied to `out`
+   */
+  size_t Pop(T* out, size_t max) {
+    const size_t TAIL = tail_.load(std::memory_order_relaxed);
+    const size_t AVAILABLE = head_.load(std::memory_order_acquire) - TAIL;
+    const size_t COUNT = AVAILABLE < max ? AVAILABLE : max;
+    for (size_t i = 0; i < COUNT; ++i) {
+      out[i] = buffer_[(TAIL + i) & MASK];
+    }
+    tail_.store(TAIL + COUNT, std::memory_order_release);
+    return COUNT;
+  }
+
+  /**
+   * @brief View the oldest elements in place (consumer only).
+   *
+   * The readable region may wrap around the end of the storage, so it is
+   * returned as up to two spans, oldest first. Release the elements with
+   * Consume() once they have been used.
+   */
+  std::array<std::span<const T>, 2> Peek() const {
+    const size_t TAIL = tail_.load(std::memory_order_relaxed);
+    const size_t AVAILABLE = head_.load(std::memory_order_acquire) - TAIL;
+    const size_t START = TAIL & MASK;
+    const size_t FIRST = AVAILABLE < N - START ? AVAILABLE : N - START;
+    return {std::span<const T>(buffer_.data() + START, FIRST),
+            std::span<const T>(buffer_.data(), AVAILABLE - FIRST)};
+  }
+
+  /// Release `count` elements returned by Peek() (consumer only)
+  void Consume(size_t count) {
+    tail_.store(tail_.load(std::memory_order_relaxed) + count,
+                std::memory_order_release);
+  }
+
+  /// Block until at least one element is available (consumer only)
+  void Wait() const {
+    while (true) {
+      uint32_t bell = doorbell_.load(std::memory_order_acquire);
+      if (!Empty()) {
+        return;
+      }
+      doorbell_.wait(bell, std::memory_order_acquire);
+    }
+  }
+
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  size_t Size() const {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+
+  /// Elements dropped because the consumer fell behind
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr size_t MASK = N - 1;
+
+  bool Write(const T& value) {
+    const size_t HEAD = head_.load(std::memory_order_relaxed);
+    if (HEAD - cached_tail_ == N) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (HEAD - cached_tail_ == N) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    buffer_[HEAD & MASK] = value;
+    head_.store(HEAD + 1, std::memory_order_release);
+    return true;
+  }
+
+  void Ring() {
+    doorbell_.fetch_add(1, std::memory_order_release);
+    doorbell_.notify_one();
+  }
+
+  /* Producer and consumer indices live on separate cache lines */
+  alignas(64) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0; /* Producer's last view of tail_ */
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<uint32_t> doorbell_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::array<T, N> buffer_{};
+};
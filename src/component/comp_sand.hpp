@@ -1,8 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <random>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -11,6 +16,25 @@ class SandGrid {
   static constexpr int SIZE = 16;
   static constexpr float PI = 3.14159265f;
 
+  /// Row-wise center-outward traversal, bottom-up
+  using TraversalOrder = std::array<std::pair<int, int>, SIZE * SIZE>;
+
+  static constexpr TraversalOrder BuildTraversalOrder() {
+    TraversalOrder order{};
+    size_t n = 0;
+    for (int r = SIZE - 1; r >= 0; --r) {
+      int center = SIZE / 2;
+      order[n++] = {r, center};
+      for (int offset = 1; offset < SIZE; ++offset) {
+        int left = center - offset;
+        int right = center + offset;
+        if (left >= 0) order[n++] = {r, left};
+        if (right < SIZE) order[n++] = {r, right};
+      }
+    }
+    return order;
+  }
+
   const std::array<std::array<bool, SIZE>, SIZE>& GetGrid() const {
     return grid_;
   }
@@ -20,45 +44,41 @@ class SandGrid {
   }
 
   void SetCell(int r, int c, bool val) {
-    if (InBounds(r, c)) grid_[r][c] = val;
+    if (InBounds(r, c)) Place(r, c, val);
   }
 
   bool AddNewSand() {
     if (grid_[15][15] == false) {
-      grid_[15][15] = true;
+      Place(15, 15, true);
       return true;
     } else {
       return false;
     }
   }
 
+  /// Drop a grain on a random empty cell next to an existing grain
   bool AddGrainNearExisting() {
-    std::vector<std::pair<int, int>> candidates;
-    for (int row = 0; row < SIZE; ++row) {
-      for (int col = 0; col < SIZE; ++col) {
-        if (grid_[row][col]) {
-          for (int dr = -1; dr <= 1; ++dr) {
-            for (int dc = -1; dc <= 1; ++dc) {
-              if (dr == 0 && dc == 0) continue;
-              int nr = row + dr;
-              int nc = col + dc;
-              if (InBounds(nr, nc) && !grid_[nr][nc]) {
-                candidates.emplace_back(nr, nc);
-              }
-            }
-          }
-        }
-      }
+    int total = 0;
+    for (uint16_t row : frontier_) {
+      total += std::popcount(row);
     }
 
-    if (candidates.empty()) return false;
-    std::uniform_int_distribution<int> dist(0, candidates.size() - 1);
-    auto [r, c] = candidates[dist(rng_)];
-    grid_[r][c] = true;
-    return true;
+    if (total == 0) return false;
+    std::uniform_int_distribution<int> dist(0, total - 1);
+    int pick = dist(rng_);
+    for (int r = 0; r < SIZE; ++r) {
+      int n = std::popcount(frontier_[r]);
+      if (pick < n) {
+        Place(r, SelectBit(frontier_[r], pick), true);
+        return true;
+      }
+      pick -= n;
+    }
+    return false;
   }
 
-  void StepOnce(float gravity_deg) {
+  /// Advance one frame; returns false if no grain moved
+  bool StepOnce(float gravity_deg) {
     // Rotate gravity by 225 degrees to align with visual direction
     gravity_deg += 225.0f;
     if (gravity_deg >= 360.0f) gravity_deg -= 360.0f;
@@ -69,7 +89,7 @@ class SandGrid {
     float gy = std::sin(angle_rad);
 
     // Define all 8 possible neighboring directions
-    static const std::vector<std::pair<int, int>> directions = {
+    static constexpr std::pair<int, int> directions[] = {
         {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1},
     };
 
@@ -77,27 +97,16 @@ class SandGrid {
     std::uniform_real_distribution<float> noise_dist(-30.0f, 30.0f);
 
     // List of sand moves to perform this frame: (from_row, from_col, to_row,
-    // to_col)
-    std::vector<std::tuple<int, int, int, int>> moves;
+    // to_col); each cell moves at most once
+    std::array<std::tuple<int, int, int, int>, SIZE * SIZE> moves;
+    size_t move_count = 0;
 
     // Tracks which cells are already targeted to avoid collision
     std::array<std::array<bool, SIZE>, SIZE> occupied_next = {};
 
-    // ==== Custom row-wise center-outward traversal (bottom-up) ====
-    std::vector<std::pair<int, int>> traversal_order;
-    for (int r = SIZE - 1; r >= 0; --r) {
-      int center = SIZE / 2;
-      traversal_order.emplace_back(r, center);
-      for (int offset = 1; offset < SIZE; ++offset) {
-        int left = center - offset;
-        int right = center + offset;
-        if (left >= 0) traversal_order.emplace_back(r, left);
-        if (right < SIZE) traversal_order.emplace_back(r, right);
-      }
-    }
-
     // ==== Traverse and decide moves ====
-    for (auto [r, c] : traversal_order) {
+    static constexpr TraversalOrder TRAVERSAL_ORDER = BuildTraversalOrder();
+    for (auto [r, c] : TRAVERSAL_ORDER) {
       if (!grid_[r][c]) continue;  // Skip if no sand
 
       float noise_deg = noise_dist(rng_);
@@ -138,48 +147,46 @@ class SandGrid {
 
         if (!occupied_next[nr][nc]) {
           occupied_next[nr][nc] = true;
-          moves.emplace_back(r, c, nr, nc);
+          moves[move_count++] = std::make_tuple(r, c, nr, nc);
         }
       }
     }
 
     // ==== Perform all queued moves ====
-    for (auto [r, c, nr, nc] : moves) {
-      grid_[r][c] = false;
-      grid_[nr][nc] = true;
+    for (size_t i = 0; i < move_count; ++i) {
+      auto [r, c, nr, nc] = moves[i];
+      Place(r, c, false);
+      Place(nr, nc, true);
     }
 
     // Optional: Debug output
     // std::cout << "[StepOnce] Moved " << moves.size() << " sand particles\n";
+    return move_count > 0;
   }
 
   void Clear() {
     for (auto& row : grid_) {
       row.fill(false);
     }
+    occupied_.fill(0);
+    frontier_.fill(0);
+    count_ = 0;
   }
 
-  int Count() const {
-    int total = 0;
-    for (const auto& row : grid_) {
-      for (bool v : row) {
-        total += v;
-      }
-    }
-    return total;
-  }
+  /// Number of grains, maintained on every change
+  int Count() const { return count_; }
 
   static bool MoveSand(SandGrid* up, SandGrid* down, float angle) {
     if (angle < 90 || angle > 270) {
       if (up->grid_[0][0] && !down->grid_[15][15]) {
-        down->grid_[15][15] = true;
-        up->grid_[0][0] = false;
+        down->Place(15, 15, true);
+        up->Place(0, 0, false);
         return true;
       }
     } else {
       if (!up->grid_[0][0] && down->grid_[15][15]) {
-        up->grid_[0][0] = true;
-        down->grid_[15][15] = false;
+        up->Place(0, 0, true);
+        down->Place(15, 15, false);
         return true;
       }
     }
@@ -223,6 +230,19 @@ class SandGrid {
       test.AddGrainNearExisting();  // Fill a bit
     }
 
+    // Test incremental Count against a full scan
+    test.StepOnce(0.0f);
+    int scanned = 0;
+    for (int r = 0; r < SIZE; ++r) {
+      for (int c = 0; c < SIZE; ++c) {
+        scanned += test.GetCell(r, c);
+      }
+    }
+    bool match = test.Count() == scanned;
+    std::cout << std::format("[Test] Count {} vs scan {} → {}\n",
+                             test.Count(), scanned,
+                             match ? "✅ Match" : "❌ Mismatch");
+
     std::vector<float> times;
     times.reserve(100);
     for (int i = 0; i < 100; ++i) {
@@ -250,7 +270,485 @@ class SandGrid {
     return r >= 0 && r < SIZE && c >= 0 && c < SIZE;
   }
 
+  /// Column of the n-th (0-based) set bit in row
+  static int SelectBit(uint16_t row, int n) {
+    while (n-- > 0) {
+      row &= static_cast<uint16_t>(row - 1);
+    }
+    return std::countr_zero(row);
+  }
+
+  /// Single write path keeping count_, occupied_ and frontier_ in sync
+  void Place(int r, int c, bool val) {
+    if (grid_[r][c] == val) return;
+    grid_[r][c] = val;
+    occupied_[r] ^= static_cast<uint16_t>(1U << c);
+    count_ += val ? 1 : -1;
+
+    /* Only the rows around r can change their neighbourhood */
+    for (int fr = std::max(r - 1, 0); fr <= std::min(r + 1, SIZE - 1); ++fr) {
+      uint16_t around = occupied_[fr];
+      if (fr > 0) around |= occupied_[fr - 1];
+      if (fr < SIZE - 1) around |= occupied_[fr + 1];
+      uint16_t dilated =
+          static_cast<uint16_t>(around | (around << 1) | (around >> 1));
+      frontier_[fr] = static_cast<uint16_t>(dilated & ~occupied_[fr]);
+    }
+  }
+
   std::array<std::array<bool, SIZE>, SIZE> grid_ = {};
+  std::array<uint16_t, SIZE> occupied_ = {}; /* Bit c of row r = grid_[r][c] */
+  std::array<uint16_t, SIZE> frontier_ = {}; /* Empty cells next to a grain */
+  int count_ = 0;
+
+  std::mt19937 rng_{std::random_device{}()};
+};
+
+/**
+ * @brief Bit-packed sand grid backend.
+ *
+ * Same behaviour as SandGrid, but the grid is stored row-major as one bit
+ * mask per row (bit c = column c) and the per-grain direction search is
+ * replaced by a constexpr table of direction preferences indexed by the
+ * quantized gravity angle. StepOnce visits set bits only, so its cost grows
+ * with the number of grains rather than the number of cells; it uses no
+ * trigonometry and no heap allocation.
+ *
+ * @tparam W Grid width in cells (at most 64)
+ * @tparam H Grid height in cells
+ */
+template <int W = 16, int H = W>
+class SandBitboard {
+  static_assert(W >= 2 && W <= 64 && H >= 2,
+                "SandBitboard supports 2 to 64 columns");
+
+ public:
+  static constexpr int WIDTH = W;
+  static constexpr int HEIGHT = H;
+  using Row = std::conditional_t<
+      (W <= 16), uint16_t, std::conditional_t<(W <= 32), uint32_t, uint64_t>>;
+  using Rows = std::array<Row, H>;
+
+  /// Gravity angle quantization steps over 360 degrees
+  static constexpr int ANGLE_STEPS = 128;
+
+  const Rows& GetRows() const { return rows_; }
+
+  bool GetCell(int r, int c) const {
+    return InBounds(r, c) ? ((rows_[r] >> c) & 1U) != 0 : false;
+  }
+
+  void SetCell(int r, int c, bool val) {
+    if (!InBounds(r, c) || GetCell(r, c) == val) return;
+    Place(r, c, val);
+  }
+
+  bool AddNewSand() {
+    if (GetCell(H - 1, W - 1)) {
+      return false;
+    }
+    SetCell(H - 1, W - 1, true);
+    return true;
+  }
+
+  bool AddGrainNearExisting() {
+    if (frontier_count_ == 0) return false;
+    std::uniform_int_distribution<int> dist(0, frontier_count_ - 1);
+    int pick = dist(rng_);
+    for (int r = 0; r < H; ++r) {
+      int n = std::popcount(frontier_[r]);
+      if (pick < n) {
+        Place(r, SelectBit(frontier_[r], pick), true);
+        return true;
+      }
+      pick -= n;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Advance one frame.
+   * @return false when the pile is at rest: no grain has a free cell in the
+   * gravity cone. A grain held back by the noise test still counts as
+   * moving, so a false result is stable for the same gravity.
+   */
+  bool StepOnce(float gravity_deg) {
+    const MoveRule& rule = RuleFor(gravity_deg);
+
+    Rows next = rows_;
+    Rows claimed{};
+    bool active = false;
+    int first_moved = H; /* Rows touched by a move, for the frontier */
+    int last_moved = -1;
+
+    /* Bottom-up rows, center-outward columns (same order as SandGrid) */
+    for (int r = H - 1; r >= 0; --r) {
+      Row movable = static_cast<Row>(rows_[r] & CandidateMask(rule, r));
+      if (movable == 0) continue;
+
+      /* Left half is scanned from the center down, right half up */
+      Row left = movable & LEFT_MASK;
+      Row right = movable & RIGHT_MASK;
+      while (left != 0 || right != 0) {
+        int c = 0;
+        int left_col = left ? (std::bit_width(left) - 1) : -1;
+        int right_col = right ? std::countr_zero(right) : W;
+        if (left && CENTER - left_col <= right_col - CENTER) {
+          c = left_col;
+          left &= static_cast<Row>(~Bit(c));
+        } else {
+          c = right_col;
+          right &= static_cast<Row>(~Bit(c));
+        }
+
+        uint32_t noise = NextRandom() & 0xFF;
+        for (int i = 0; i < rule.count; ++i) {
+          const auto& dir = DIRECTIONS[rule.dir[i]];
+          int nr = r + dir.first;
+          int nc = c + dir.second;
+          if (!InBounds(nr, nc) || ((rows_[nr] >> nc) & 1U)) continue;
+
+          /* Best free direction found; accept it with the noise test */
+          active = true;
+          if (noise < rule.threshold[i] && !((claimed[nr] >> nc) & 1U)) {
+            claimed[nr] |= Bit(nc);
+            next[r] &= static_cast<Row>(~Bit(c));
+            next[nr] |= Bit(nc);
+            first_moved = std::min({first_moved, r, nr});
+            last_moved = std::max({last_moved, r, nr});
+          }
+          break;
+        }
+      }
+    }
+
+    rows_ = next;
+    if (last_moved >= 0) {
+      RefreshFrontier(first_moved - 1, last_moved + 1);
+    }
+    return active;
+  }
+
+  void Clear() {
+    rows_.fill(0);
+    frontier_.fill(0);
+    count_ = 0;
+    frontier_count_ = 0;
+  }
+
+  /// Number of grains; StepOnce only moves grains, so this is tracked
+  int Count() const { return count_; }
+
+  /// Pass one grain between the upper bulb's first cell and the lower
+  /// bulb's last cell, in the direction of gravity
+  static bool MoveSand(SandBitboard* up, SandBitboard* down, float angle) {
+    constexpr int LAST_ROW = H - 1;
+    constexpr int LAST_COL = W - 1;
+    if (angle < 90 || angle > 270) {
+      if (up->GetCell(0, 0) && !down->GetCell(LAST_ROW, LAST_COL)) {
+        down->SetCell(LAST_ROW, LAST_COL, true);
+        up->SetCell(0, 0, false);
+        return true;
+      }
+    } else {
+      if (!up->GetCell(0, 0) && down->GetCell(LAST_ROW, LAST_COL)) {
+        up->SetCell(0, 0, true);
+        down->SetCell(LAST_ROW, LAST_COL, false);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void RunUnitTest() {
+    std::cout << "[SandBitboard::UnitTest] Starting bitboard sand test...\n";
+
+    if constexpr (W == SandGrid::SIZE && H == SandGrid::SIZE) {
+      CompareWithReference();
+    }
+    CheckFrontier();
+
+    /* Step time vs. grid size, half full, against the 25 ms frame */
+    BenchmarkSize<16, 16>();
+    BenchmarkSize<32, 32>();
+    BenchmarkSize<64, 32>();
+    BenchmarkSize<64, 64>();
+
+    std::cout << "[SandBitboard::UnitTest] ✅ Test complete.\n";
+  }
+
+ private:
+  /// Compare against the reference SandGrid on the same start state
+  void CompareWithReference() {
+    SandGrid reference;
+    SandBitboard test;
+    reference.Clear();
+    test.Clear();
+    test.SetCell(H / 2, W / 2, true);
+    for (int i = 0; i < 50; ++i) {
+      test.AddGrainNearExisting();
+    }
+    for (int r = 0; r < H; ++r) {
+      for (int c = 0; c < W; ++c) {
+        reference.SetCell(r, c, test.GetCell(r, c));
+      }
+    }
+
+    int before = test.Count();
+    for (int i = 0; i < 200; ++i) {
+      reference.StepOnce(0.0f);
+      test.StepOnce(0.0f);
+    }
+    std::cout << std::format("[Test] StepOnce x200 → Particle count: {} → {}\n",
+                             before, test.Count());
+
+    auto centroid = [](auto& grid) {
+      float sum_r = 0.0f, sum_c = 0.0f;
+      int n = 0;
+      for (int r = 0; r < H; ++r) {
+        for (int c = 0; c < W; ++c) {
+          if (grid.GetCell(r, c)) {
+            sum_r += static_cast<float>(r);
+            sum_c += static_cast<float>(c);
+            n++;
+          }
+        }
+      }
+      return n ? std::pair{sum_r / n, sum_c / n} : std::pair{0.0f, 0.0f};
+    };
+
+    auto [ref_r, ref_c] = centroid(reference);
+    auto [bit_r, bit_c] = centroid(test);
+    bool same = std::fabs(ref_r - bit_r) < 1.0f && std::fabs(ref_c - bit_c) < 1.0f;
+    std::cout << std::format(
+        "[Test] Settled centroid → reference ({:.2f}, {:.2f}) | bitboard "
+        "({:.2f}, {:.2f}) {}\n",
+        ref_r, ref_c, bit_r, bit_c, same ? "✅ Match" : "❌ Mismatch");
+
+    /* StepOnce performance test (same load as SandGrid::RunUnitTest) */
+    std::vector<float> times;
+    times.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+      auto start = std::chrono::high_resolution_clock::now();
+      test.StepOnce(static_cast<float>(i * 7 % 360));
+      auto end = std::chrono::high_resolution_clock::now();
+      times.push_back(
+          std::chrono::duration<float, std::micro>(end - start).count());
+    }
+
+    auto [min_it, max_it] = std::minmax_element(times.begin(), times.end());
+    float avg =
+        std::accumulate(times.begin(), times.end(), 0.0f) / times.size();
+
+    std::cout << std::format(
+        "[Perf] StepOnce timing (µs): min = {:>6.2f}, max = {:>6.2f}, avg = "
+        "{:>6.2f}\n",
+        *min_it, *max_it, avg);
+  }
+
+  /// The incremental frontier must match a full rebuild after any mutation
+  void CheckFrontier() {
+    SandBitboard test;
+    test.SetCell(H / 2, W / 2, true);
+    bool same = true;
+    for (int i = 0; i < 200 && same; ++i) {
+      test.AddGrainNearExisting();
+      test.StepOnce(static_cast<float>(i * 13 % 360));
+      if (i % 7 == 0) {
+        test.SetCell(i % H, (i * 3) % W, false);
+      }
+      Rows expected = test.frontier_;
+      int expected_count = test.frontier_count_;
+      test.frontier_.fill(0);
+      test.frontier_count_ = 0;
+      test.RefreshFrontier(0, H - 1);
+      same = expected == test.frontier_ &&
+             expected_count == test.frontier_count_;
+    }
+    std::cout << std::format("[Test] Incremental frontier → {}\n",
+                             same ? "✅ Matches full rebuild" : "❌ Mismatch");
+  }
+
+  /// Time StepOnce on a half-full BW x BH grid with turning gravity
+  template <int BW, int BH>
+  static void BenchmarkSize() {
+    constexpr int STEPS = 200;
+    constexpr float FRAME_US = 25000.0f;
+
+    SandBitboard<BW, BH> grid;
+    grid.SetCell(BH / 2, BW / 2, true);
+    while (grid.Count() < BW * BH / 2 && grid.AddGrainNearExisting()) {
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < STEPS; ++i) {
+      grid.StepOnce(static_cast<float>(i * 7 % 360));
+    }
+    auto end = std::chrono::steady_clock::now();
+    float avg = std::chrono::duration<float, std::micro>(end - start).count() /
+                STEPS;
+
+    std::cout << std::format(
+        "[Perf] {:>2}x{:<2} ({:>2} chips/bulb, {:>4} grains): StepOnce "
+        "{:>8.2f} µs = {:>5.2f}% of a 25 ms frame\n",
+        BW, BH, BW * BH / 64, grid.Count(), avg, avg * 100.0f / FRAME_US);
+  }
+
+  /// Preferred directions for one quantized gravity angle
+  struct MoveRule {
+    uint8_t count;                     ///< Number of usable directions
+    std::array<uint8_t, 8> dir;        ///< Indices into DIRECTIONS, best first
+    std::array<uint16_t, 8> threshold; ///< Accept if noise byte < threshold
+  };
+
+  static constexpr int CENTER = W / 2;
+  static constexpr Row COLS_MASK = static_cast<Row>(
+      static_cast<Row>(~Row{0}) >> (std::numeric_limits<Row>::digits - W));
+  static constexpr Row LEFT_MASK = static_cast<Row>((Row{1} << CENTER) - 1U);
+  static constexpr Row RIGHT_MASK = static_cast<Row>(~LEFT_MASK & COLS_MASK);
+
+  /// Same neighbour order as SandGrid::StepOnce (row delta, column delta)
+  static constexpr std::array<std::pair<int, int>, 8> DIRECTIONS = {{
+      {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1},
+  }};
+
+  /// Direction angles in degrees for (vx = dc, vy = dr)
+  static constexpr std::array<float, 8> DIRECTION_DEG = {
+      225.0f, 270.0f, 315.0f, 180.0f, 0.0f, 135.0f, 90.0f, 45.0f,
+  };
+
+  /**
+   * @brief Build the move table.
+   *
+   * SandGrid accepts the best free direction when its angle to gravity is
+   * below 55° ± 30° of uniform noise, i.e. with probability
+   * (85° - angle) / 60°. Directions are sorted by angle (ties keep the
+   * DIRECTIONS order) and the probability is stored as a byte threshold.
+   */
+  static constexpr std::array<MoveRule, ANGLE_STEPS> BuildMoveTable() {
+    std::array<MoveRule, ANGLE_STEPS> table{};
+    for (int step = 0; step < ANGLE_STEPS; ++step) {
+      /* SandGrid rotates gravity by 225° before use */
+      float gravity = static_cast<float>(step) * 360.0f / ANGLE_STEPS + 225.0f;
+      if (gravity >= 360.0f) gravity -= 360.0f;
+
+      std::array<float, 8> angle{};
+      for (int d = 0; d < 8; ++d) {
+        float diff = DIRECTION_DEG[d] - gravity;
+        if (diff < 0.0f) diff = -diff;
+        angle[d] = diff > 180.0f ? 360.0f - diff : diff;
+      }
+
+      MoveRule& rule = table[step];
+      rule.count = 0;
+      std::array<bool, 8> used{};
+      for (int n = 0; n < 8; ++n) {
+        int best = -1;
+        for (int d = 0; d < 8; ++d) {
+          if (!used[d] && (best < 0 || angle[d] < angle[best])) best = d;
+        }
+        used[best] = true;
+
+        float p = (85.0f - angle[best]) / 60.0f;
+        p = p > 1.0f ? 1.0f : p;
+        int threshold = static_cast<int>(p * 256.0f + 0.5f);
+        if (threshold <= 0) break;
+
+        rule.dir[rule.count] = static_cast<uint8_t>(best);
+        rule.threshold[rule.count] = static_cast<uint16_t>(threshold);
+        rule.count++;
+      }
+    }
+    return table;
+  }
+
+  /// Move rule for a gravity angle (degrees, before the 225° rotation)
+  static const MoveRule& RuleFor(float gravity_deg) {
+    static constexpr std::array<MoveRule, ANGLE_STEPS> MOVE_TABLE =
+        BuildMoveTable();
+    return MOVE_TABLE[AngleIndex(gravity_deg)];
+  }
+
+  static int AngleIndex(float gravity_deg) {
+    int index = static_cast<int>(
+        std::floor(gravity_deg * ANGLE_STEPS / 360.0f + 0.5f));
+    index %= ANGLE_STEPS;
+    return index < 0 ? index + ANGLE_STEPS : index;
+  }
+
+  /// Grains in row r that have at least one free preferred neighbour
+  Row CandidateMask(const MoveRule& rule, int r) const {
+    Row mask = 0;
+    for (int i = 0; i < rule.count; ++i) {
+      const auto& dir = DIRECTIONS[rule.dir[i]];
+      int nr = r + dir.first;
+      if (nr < 0 || nr >= H) continue;
+      Row free = static_cast<Row>(~rows_[nr]);
+      if (dir.second > 0) {
+        free = static_cast<Row>(free >> 1);
+      } else if (dir.second < 0) {
+        free = static_cast<Row>(free << 1);
+      }
+      mask |= free;
+    }
+    return mask;
+  }
+
+  static constexpr Row Bit(int c) { return static_cast<Row>(Row{1} << c); }
+
+  /// Column of the n-th (0-based) set bit in row
+  static int SelectBit(Row row, int n) {
+    while (n-- > 0) {
+      row &= static_cast<Row>(row - 1);
+    }
+    return std::countr_zero(row);
+  }
+
+  /// xorshift32, enough for per-grain noise
+  uint32_t NextRandom() {
+    rng_state_ ^= rng_state_ << 13;
+    rng_state_ ^= rng_state_ >> 17;
+    rng_state_ ^= rng_state_ << 5;
+    return rng_state_;
+  }
+
+  bool InBounds(int r, int c) const {
+    return r >= 0 && r < H && c >= 0 && c < W;
+  }
+
+  /// Single write path keeping count_ and the frontier in sync
+  void Place(int r, int c, bool val) {
+    if (val) {
+      rows_[r] |= Bit(c);
+      count_++;
+    } else {
+      rows_[r] &= static_cast<Row>(~Bit(c));
+      count_--;
+    }
+    RefreshFrontier(r - 1, r + 1);
+  }
+
+  /// Recompute the frontier of rows [first, last] (clamped to the grid)
+  void RefreshFrontier(int first, int last) {
+    for (int r = std::max(first, 0); r <= std::min(last, H - 1); ++r) {
+      Row around = rows_[r];
+      if (r > 0) around |= rows_[r - 1];
+      if (r < H - 1) around |= rows_[r + 1];
+      Row dilated = static_cast<Row>(around | (around << 1) | (around >> 1));
+      Row frontier = static_cast<Row>(dilated & ~rows_[r] & COLS_MASK);
+      frontier_count_ += std::popcount(frontier) - std::popcount(frontier_[r]);
+      frontier_[r] = frontier;
+    }
+  }
+
+  Rows rows_ = {};
+  Rows frontier_ = {}; /* Empty cells in the 8-neighbourhood of a grain */
+  int count_ = 0;
+  int frontier_count_ = 0;
 
   std::mt19937 rng_{std::random_device{}()};
+  uint32_t rng_state_ = std::random_device{}() | 1U;
 };
+
+/// Sand backend used by the GUI (SandGrid is kept as the reference model)
+using SandEngine = SandBitboard<>;
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bsp_thread.hpp"
+
+/**
+ * @brief Shared scheduler for periodic and one-shot jobs.
+ *
+ * Every job owns a CLOCK_MONOTONIC timerfd armed with an absolute first
+ * deadline and a fixed interval, so the kernel keeps the cadence and a slow
+ * callback never shifts later deadlines. A small pool of workers waits on a
+ * single epoll set; EPOLLONESHOT keeps a job on at most one worker at a
+ * time. Wakeups past the deadline are reported as jitter, and whole periods
+ * that elapsed before a job ran are reported as missed deadlines.
+ *
+ * Callbacks run on the worker threads and should not block; hand long work
+ * to another thread or split it across timers.
+ */
+class TimerService {
+ public:
+  using Callback = std::function<void()>;
+  using TimerId = uint32_t;
+
+  /// Returned when a timer could not be created
+  static constexpr TimerId INVALID_TIMER = 0;
+
+  /// Worker count of the process-wide service
+  static constexpr size_t DEFAULT_WORKERS = 2;
+
+  /// Timing counters of one job, or of all jobs
+  struct Stats {
+    uint64_t runs;          ///< Callback invocations
+    uint64_t missed;        ///< Deadlines that passed without a run
+    int64_t max_jitter_us;  ///< Worst wakeup delay past the deadline
+    float avg_jitter_us;    ///< Mean wakeup delay past the deadline
+  };
+
+  /**
+   * @brief Create the epoll set and start the workers.
+   * @param workers Number of worker threads
+   * @param name Thread name prefix, shown as "<name>-<index>"
+   * @param role Placement applied by every worker, e.g. a private service
+   * for a realtime job; its name replaces `name`
+   */
+  explicit TimerService(
+      size_t workers = DEFAULT_WORKERS, const std::string& name = "timer",
+      std::optional<ThreadConfig::Role> role = std::nullopt)
+      : role_(role) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+      std::perror("TimerService init failed");
+      return;
+    }
+
+    /* Level-triggered and never drained: wakes every worker on shutdown */
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = INVALID_TIMER;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    for (size_t i = 0; i < workers; ++i) {
+      workers_.emplace_back(&TimerService::WorkerTask, this);
+      if (!role_) {
+        std::string thread_name = std::format("{}-{}", name, i).substr(0, 15);
+        pthread_setname_np(workers_.back().native_handle(),
+                           thread_name.c_str());
+      }
+    }
+  }
+
+  ~TimerService() {
+    running_ = false;
+    if (wake_fd_ >= 0) {
+      uint64_t one = 1;
+      (void)(write(wake_fd_, &one, sizeof(one)));
+    }
+    for (auto& worker : workers_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+    timers_.clear();
+    if (wake_fd_ >= 0) close(wake_fd_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+  }
+
+  TimerService(const TimerService&) = delete;
+  TimerService& operator=(const TimerService&) = delete;
+
+  /// Process-wide service shared by the drivers and the GUI
+  static TimerService& Default() {
+    static TimerService service(DEFAULT_WORKERS);
+    return service;
+  }
+
+  /**
+   * @brief Run a callback every `period`.
+   * @param period Interval between deadlines
+   * @param callback Job to run on a worker thread
+   * @param first_delay Delay of the first deadline; one period if zero
+   * @return Timer handle, or INVALID_TIMER on failure
+   */
+  TimerId AddPeriodic(std::chrono::nanoseconds period, Callback callback,
+                      std::chrono::nanoseconds first_delay =
+                          std::chrono::nanoseconds::zero()) {
+    return Add(period, std::move(callback),
+               first_delay.count() > 0 ? first_delay : period, false);
+  }
+
+  /**
+   * @brief Run a callback once after `delay`; the timer removes itself.
+   * @return Timer handle, or INVALID_TIMER on failure
+   */
+  TimerId AddOneShot(std::chrono::nanoseconds delay, Callback callback) {
+    return Add(std::chrono::nanoseconds::zero(), std::move(callback),
+               delay.count() > 0 ? delay : std::chrono::nanoseconds(1), true);
+  }
+
+  /// Stop a periodic timer without removing it; safe from its own callback
+  void Pause(TimerId id) {
+    auto timer = Find(id);
+    if (!timer) return;
+    itimerspec spec{};
+    timerfd_settime(timer->fd, 0, &spec, nullptr);
+  }
+
+  /// Re-arm a paused timer, next deadline one period from now
+  void Resume(TimerId id) {
+    auto timer = Find(id);
+    if (!timer || timer->one_shot) return;
+    Arm(*timer, NowNs() + timer->period_ns, timer->period_ns);
+  }
+
+  /**
+   * @brief Change the interval of a periodic timer; safe from its callback.
+   *
+   * The timer is re-armed (also if paused) with its next deadline after
+   * `first_delay`, or one new period from now if zero.
+   */
+  void SetPeriod(TimerId id, std::chrono::nanoseconds period,
+                 std::chrono::nanoseconds first_delay =
+                     std::chrono::nanoseconds::zero()) {
+    auto timer = Find(id);
+    if (!timer || timer->one_shot || period.count() <= 0) return;
+    timer->period_ns = period.count();
+    Arm(*timer,
+        NowNs() + (first_delay.count() > 0 ? first_delay : period).count(),
+        timer->period_ns);
+  }
+
+  /**
+   * @brief Cancel a timer and wait for a running callback to return.
+   *
+   * Must not be called from the timer's own callback.
+   */
+  void Remove(TimerId id) {
+    std::shared_ptr<Timer> timer;
+    {
+      std::lock_guard<std::mutex> lock(timers_mutex_);
+      auto it = timers_.find(id);
+      if (it == timers_.end()) return;
+      timer = std::move(it->second);
+      timers_.erase(it);
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, timer->fd, nullptr);
+    std::lock_guard<std::mutex> lock(timer->run_mutex);
+    timer->removed = true;
+  }
+
+  /// Timing counters of one timer
+  Stats GetStats(TimerId id) const {
+    auto timer = Find(id);
+    return timer ? ToStats(timer->runs, timer->missed, timer->max_jitter_ns,
+                           timer->total_jitter_ns)
+                 : Stats{};
+  }
+
+  /// Timing counters summed over all live timers
+  Stats GetTotalStats() const {
+    uint64_t runs = 0, missed = 0;
+    int64_t max_jitter = 0, total_jitter = 0;
+    std::lock_guard<std::mutex> lock(timers_mutex_);
+    for (const auto& [id, timer] : timers_) {
+      runs += timer->runs;
+      missed += timer->missed;
+      max_jitter = std::max<int64_t>(max_jitter, timer->max_jitter_ns);
+      total_jitter += timer->total_jitter_ns;
+    }
+    return ToStats(runs, missed, max_jitter, total_jitter);
+  }
+
+  void RunUnitTest() {
+    std::cout << "[TimerService::UnitTest] Starting timer service test...\n";
+
+    std::atomic<int> periodic_runs{0};
+    std::atomic<int> one_shot_runs{0};
+    TimerId periodic = AddPeriodic(std::chrono::milliseconds(5),
+                                   [&]() { periodic_runs++; });
+    AddOneShot(std::chrono::milliseconds(20), [&]() { one_shot_runs++; });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    Stats stats = GetStats(periodic);
+    std::cout << std::format(
+        "[Test] 5 ms job over 500 ms → runs: {} | missed: {} | jitter avg "
+        "{:.1f} µs, max {} µs\n",
+        stats.runs, stats.missed, stats.avg_jitter_us, stats.max_jitter_us);
+    std::cout << std::format("[Test] One-shot → {}\n",
+                             one_shot_runs == 1 ? "✅ Fired once"
+                                                : "❌ Wrong count");
+
+    Pause(periodic);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    int paused_at = periodic_runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::cout << std::format("[Test] Pause → {}\n",
+                             periodic_runs == paused_at ? "✅ Stopped"
+                                                        : "❌ Still running");
+
+    Resume(periodic);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::cout << std::format("[Test] Resume → {}\n",
+                             periodic_runs > paused_at ? "✅ Running"
+                                                       : "❌ Stopped");
+
+    SetPeriod(periodic, std::chrono::milliseconds(50));
+    int slowed_at = periodic_runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(275));
+    int slowed_runs = periodic_runs - slowed_at;
+    std::cout << std::format("[Test] SetPeriod 50 ms over 275 ms → {}\n",
+                             slowed_runs >= 4 && slowed_runs <= 6
+                                 ? "✅ Slowed down"
+                                 : "❌ Wrong rate");
+    Remove(periodic);
+
+    std::cout << "[TimerService::UnitTest] ✅ Test complete.\n";
+  }
+
+ private:
+  struct Timer {
+    ~Timer() {
+      if (fd >= 0) close(fd);
+    }
+
+    int fd = -1;
+    bool one_shot = false;
+    std::atomic<int64_t> period_ns{0}; /* Changed by SetPeriod() */
+    Callback callback;
+
+    std::mutex run_mutex; /* Held while the callback runs */
+    bool removed = false; /* Guarded by run_mutex */
+
+    std::atomic<int64_t> deadline_ns{0}; /* Next expected expiry */
+    std::atomic<uint64_t> runs{0};
+    std::atomic<uint64_t> missed{0};
+    std::atomic<int64_t> max_jitter_ns{0};
+    std::atomic<int64_t> total_jitter_ns{0};
+  };
+
+  static int64_t NowNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  static timespec ToTimespec(int64_t ns) {
+    return timespec{static_cast<time_t>(ns / 1000000000),
+                    static_cast<long>(ns % 1000000000)};
+  }
+
+  static Stats ToStats(uint64_t runs, uint64_t missed, int64_t max_jitter_ns,
+                       int64_t total_jitter_ns) {
+    return Stats{runs, missed, max_jitter_ns / 1000,
+                 runs ? static_cast<float>(total_jitter_ns) / 1000.0f /
+                            static_cast<float>(runs)
+                      : 0.0f};
+  }
+
+  /* Absolute first deadline, so the cadence is anchored to the clock */
+  static void Arm(Timer& timer, int64_t deadline_ns, int64_t period_ns) {
+    timer.deadline_ns = deadline_ns;
+    itimerspec spec{};
+    spec.it_value = ToTimespec(deadline_ns);
+    spec.it_interval = ToTimespec(period_ns);
+    timerfd_settime(timer.fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+  }
+
+  TimerId Add(std::chrono::nanoseconds period, Callback callback,
+              std::chrono::nanoseconds first_delay, bool one_shot) {
+    auto timer = std::make_shared<Timer>();
+    timer->fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer->fd < 0) {
+      std::perror("timerfd_create failed");
+      return INVALID_TIMER;
+    }
+    timer->one_shot = one_shot;
+    timer->period_ns = period.count();
+    timer->callback = std::move(callback);
+
+    TimerId id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(timers_mutex_);
+      timers_[id] = timer;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = id;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer->fd, &ev) < 0) {
+      std::perror("TimerService epoll_ctl failed");
+      std::lock_guard<std::mutex> lock(timers_mutex_);
+      timers_.erase(id);
+      return INVALID_TIMER;
+    }
+    Arm(*timer, NowNs() + first_delay.count(), timer->period_ns);
+    return id;
+  }
+
+  std::shared_ptr<Timer> Find(TimerId id) const {
+    std::lock_guard<std::mutex> lock(timers_mutex_);
+    auto it = timers_.find(id);
+    return it == timers_.end() ? nullptr : it->second;
+  }
+
+  void WorkerTask() {
+    if (role_) {
+      ThreadConfig::Apply(*role_);
+    }
+    while (running_) {
+      epoll_event ev{};
+      int n = epoll_wait(epoll_fd_, &ev, 1, -1);
+      if (n <= 0 || ev.data.u64 == INVALID_TIMER) {
+        continue; /* EINTR, or shutdown via wake_fd_ */
+      }
+      TimerId id = static_cast<TimerId>(ev.data.u64);
+      if (auto timer = Find(id)) {
+        Run(id, *timer);
+      }
+    }
+  }
+
+  void Run(TimerId id, Timer& timer) {
+    std::lock_guard<std::mutex> lock(timer.run_mutex);
+    if (timer.removed) return;
+
+    uint64_t expirations = 0;
+    if (read(timer.fd, &expirations, sizeof(expirations)) !=
+            sizeof(expirations) ||
+        expirations == 0) {
+      Rearm(id, timer); /* Paused or re-armed after the wakeup */
+      return;
+    }
+
+    /* The latest deadline that passed; earlier ones were missed */
+    int64_t now = NowNs();
+    int64_t deadline =
+        timer.deadline_ns +
+        static_cast<int64_t>(expirations - 1) * timer.period_ns;
+    int64_t jitter = now > deadline ? now - deadline : 0;
+    timer.deadline_ns = deadline + timer.period_ns;
+    timer.runs.fetch_add(1, std::memory_order_relaxed);
+    timer.missed.fetch_add(expirations - 1, std::memory_order_relaxed);
+    timer.total_jitter_ns.fetch_add(jitter, std::memory_order_relaxed);
+    if (jitter > timer.max_jitter_ns.load(std::memory_order_relaxed)) {
+      timer.max_jitter_ns.store(jitter, std::memory_order_relaxed);
+    }
+
+    timer.callback();
+
+    if (timer.one_shot) {
+      timer.removed = true;
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, timer.fd, nullptr);
+      std::lock_guard<std::mutex> timers_lock(timers_mutex_);
+      timers_.erase(id);
+    } else {
+      Rearm(id, timer);
+    }
+  }
+
+  /* EPOLLONESHOT disabled the fd after this wakeup; hand it back */
+  void Rearm(TimerId id, Timer& timer) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, timer.fd, &ev);
+  }
+
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::atomic<bool> running_{true};
+  std::atomic<TimerId> next_id_{INVALID_TIMER + 1};
+
+  mutable std::mutex timers_mutex_;
+  std::unordered_map<TimerId, std::shared_ptr<Timer>> timers_;
+  std::optional<ThreadConfig::Role> role_; /* Applied by each worker */
+  std::vector<std::thread> workers_;
+};
@@ -229,7 +229,7 @@ class CycleValue {
    *
    * @return The value as a float.
    */
-  float Value() { return value_; }
+  float Value() const { return value_; }
 
  private:
   float value_; /* The normalized cyclic value in [0, 2π). */
@@ -271,4 +271,21 @@ typedef struct {
   float z;
 } Vector3;
 
+/**
+ * @brief One IMU sample with its capture time.
+ */
+typedef struct {
+  Vector3 accel;         /* Acceleration in m/s^2 */
+  Vector3 gyro;          /* Angular rate in rad/s, bias removed */
+  uint64_t timestamp_us; /* steady_clock time of capture in microseconds */
+} ImuSample;
+
+/**
+ * @brief IMU sample together with the attitude estimated from it.
+ */
+typedef struct {
+  ImuSample imu;
+  Eulr eulr;
+} AttitudeSample;
+
 };  // namespace Type
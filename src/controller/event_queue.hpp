@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Wakes the FluxSand main loop when something that affects the screen
+// happens. Handlers apply their state change first and then post an event,
+// so the loop only has to re-evaluate what to render.
+class EventQueue {
+ public:
+  // Sources that can wake the main loop.
+  enum class Type : uint8_t {
+    BUTTON,   // User button pressed (value: button index)
+    GESTURE,  // Gesture recognized (value: ModelOutput)
+    MODE,     // Mode, orientation or timer/stopwatch state changed
+    SENSOR    // New sensor reading available
+  };
+
+  struct Event {
+    Type type;
+    int32_t value;
+  };
+
+  // Post an event from any thread. If the queue is full the oldest event
+  // is overwritten; the loop re-reads all state anyway.
+  void Post(Type type, int32_t value = 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_[(head_ + size_) % CAPACITY] = {type, value};
+      if (size_ < CAPACITY) {
+        size_++;
+      } else {
+        head_ = (head_ + 1) % CAPACITY;
+      }
+    }
+    cv_.notify_one();
+  }
+
+  // Wait for the next event until the deadline. Returns false on timeout.
+  bool WaitUntil(std::chrono::steady_clock::time_point deadline, Event& out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cv_.wait_until(lock, deadline, [this]() { return size_ > 0; })) {
+      return false;
+    }
+    out = events_[head_];
+    head_ = (head_ + 1) % CAPACITY;
+    size_--;
+    return true;
+  }
+
+  // Pop an event without waiting. Returns false if none is pending.
+  bool TryPop(Event& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ == 0) {
+      return false;
+    }
+    out = events_[head_];
+    head_ = (head_ + 1) % CAPACITY;
+    size_--;
+    return true;
+  }
+
+ private:
+  static constexpr size_t CAPACITY = 16;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::array<Event, CAPACITY> events_{};
+  size_t head_ = 0;  // Oldest pending event
+  size_t size_ = 0;  // Number of pending events
+};
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <ctime>
 #include <deque>
+#include <format>
 #include <iostream>
 #include <thread>
 
@@ -14,10 +15,13 @@
 #include "comp_ahrs.hpp"
 #include "comp_gui.hpp"
 #include "comp_inference.hpp"
+#include "comp_metrics.hpp"
+#include "event_queue.hpp"
 #include "inference_handler.hpp"
 #include "input_handler.hpp"
 #include "max7219.hpp"
 #include "mode_manager.hpp"
+#include "mpu9250.hpp"
 #include "sensor_manager.hpp"
 
 // The main application class for FluxSand, handling GUI updates,
@@ -28,7 +32,7 @@ class FluxSand {
   // inference handler, and input handler.
   FluxSand(PWM* pwm_buzzer, Gpio* gpio_user_button_1, Gpio* gpio_user_button_2,
            CompGuiX* gui, Bmp280* bmp280, Aht20* aht20, Ads1115<2>* ads1115,
-           AHRS* ahrs, InferenceEngine* inference)
+           AHRS* ahrs, InferenceEngine* inference, Mpu9250* imu)
       : pwm_buzzer_(pwm_buzzer),
         gpio_user_button_1_(gpio_user_button_1),
         gpio_user_button_2_(gpio_user_button_2),
@@ -37,9 +41,10 @@ class FluxSand {
         aht20_(aht20),
         ads1115_(ads1115),
         ahrs_(ahrs),
-        inference_(inference) {
-    // Wait for system stabilization or hardware warm-up
-    std::this_thread::sleep_for(std::chrono::milliseconds(6000));
+        inference_(inference),
+        imu_(imu) {
+    // Wait until the attitude is usable rather than a fixed warm-up
+    WaitUntilReady();
 
     // Prepare the buzzer
     pwm_buzzer_->SetDutyCycle(0.0f);
@@ -51,14 +56,15 @@ class FluxSand {
     // Initialize inference handler with inference engine and mode manager
     // and bind timer control callbacks
     inference_handler_.Init(
-        inference_, &mode_manager_, gui_, pwm_buzzer_,
+        inference_, &mode_manager_, gui_, pwm_buzzer_, &events_,
         [this](int duration) { StartTimer(duration); },
-        [this]() { StopTimer(); });
+        [this]() { StopTimer(); },
+        [this]() { imu_->RequestCalibration(); });
 
     // Initialize input handler with buttons and callbacks for stopwatch/timer
     input_handler_.Init(
         gpio_user_button_1_, gpio_user_button_2_, pwm_buzzer_, gui_,
-        &mode_manager_,
+        &mode_manager_, &events_,
         [this]() {
           if (mode_manager_.IsStopwatchRunning())
             StopStopwatch();
@@ -68,8 +74,18 @@ class FluxSand {
         [this]() { StopTimer(); });
   }
 
-  // Main update loop called repeatedly to render GUI based on current mode
+  // Main loop body: render if anything visible changed, then sleep until
+  // the display can change again or a handler posts an event.
   void Run() {
+    Render();
+    WaitForEvents();
+  }
+
+  // Advance mode logic and redraw the current mode only when its displayed
+  // content differs from the last frame. Returns true if a frame was drawn.
+  bool Render() {
+    ScopedLatency latency(Metrics::Stage::RENDER);
+
     // Get current system time
     auto now = std::chrono::system_clock::now();
     std::time_t t = std::chrono::system_clock::to_time_t(now);
@@ -78,38 +94,40 @@ class FluxSand {
     int minute = local_time->tm_min;
 
     // Update GUI with the current tilt angle
-    gui_->SetGravityDegree(ahrs_->eulr_.rol);
+    gui_->SetGravityDegree(ahrs_->GetRoll());
 
     // Get current UI mode and orientation
     auto mode = mode_manager_.GetMode();
     bool landscape = mode_manager_.IsLandscape();
 
+    // Sample the AHT20 at full rate only while its values are on screen
+    sensor_manager_.SetEnvironmentVisible(
+        mode == ModeManager::Mode::HUMIDITY ||
+        mode == ModeManager::Mode::TEMPERATURE);
+
+    // Collect everything the frame depends on
+    RenderKey key{mode, landscape, false, 0, 0};
+
     switch (mode) {
       case ModeManager::Mode::TIME:
-        // Render clock in portrait or landscape orientation
-        if (landscape)
-          gui_->RenderTimeLandscape(hour, minute);
-        else
-          gui_->RenderTimePortrait(hour, minute);
+        key.first = hour;
+        key.second = minute;
         break;
 
       case ModeManager::Mode::HUMIDITY:
-        // Display humidity reading
-        gui_->RenderHumidity(
-            static_cast<uint8_t>(sensor_manager_.GetHumidity()));
+        key.first = static_cast<uint8_t>(sensor_manager_.GetHumidity());
         break;
 
       case ModeManager::Mode::TEMPERATURE:
-        // Display compensated temperature, offset for calibration
-        gui_->RenderTemperature(static_cast<uint8_t>(
-            sensor_manager_.GetCompensatedTemperature()));
+        key.first =
+            static_cast<uint8_t>(sensor_manager_.GetCompensatedTemperature());
         break;
 
       case ModeManager::Mode::STOPWATCH: {
         // Display stopwatch time with a 100-minute limit
         int64_t display_sec = mode_manager_.GetStopwatchSeconds();
         if (display_sec >= 100 * 60 - 1) display_sec = 100 * 60 - 1;
-        gui_->RenderTimeLandscape(display_sec / 60, display_sec % 60);
+        key.first = display_sec;
         break;
       }
 
@@ -124,11 +142,13 @@ class FluxSand {
           mode_manager_.StopTimer();
         }
 
-        if (landscape) {
-          // Show remaining time in landscape format
-          gui_->RenderTimeLandscapeMS(remaining / 60, remaining % 60);
-        } else if (mode_manager_.IsTimerRunning()) {
-          // In portrait mode, animate sand flow
+        key.first = remaining;
+        key.second = mode_manager_.IsTimerRunning();
+
+        if (!landscape && mode_manager_.IsTimerRunning()) {
+          // In portrait mode, animate sand flow; the hourglass is drawn by
+          // the GUI animation thread
+          key.sand = true;
           gui_->SandEnable();
           int target_grid_down_count =
               128 - static_cast<int>(128.0f * static_cast<float>(remaining) /
@@ -137,13 +157,7 @@ class FluxSand {
           target_grid_down_count = std::clamp(target_grid_down_count, 0, 128);
 
           // Only move sand if more sand needs to fall
-          if (target_grid_down_count > gui_->grid_down_.Count()) {
-            SandGrid::MoveSand(&gui_->grid_up_, &gui_->grid_down_,
-                               gui_->gravity_deg_);
-          }
-        } else {
-          // If timer not running, show static time
-          gui_->RenderTimePortraitMS(remaining / 60, remaining % 60);
+          gui_->TransferSand(target_grid_down_count);
         }
         break;
       }
@@ -152,8 +166,72 @@ class FluxSand {
         std::cout << "Unknown mode\n";
     }
 
-    // Small delay to prevent high CPU usage
-    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (has_rendered_ && key == last_key_) {
+      return false;
+    }
+    last_key_ = key;
+    has_rendered_ = true;
+
+    switch (mode) {
+      case ModeManager::Mode::TIME:
+        // Render clock in portrait or landscape orientation
+        if (landscape)
+          gui_->RenderTimeLandscape(hour, minute);
+        else
+          gui_->RenderTimePortrait(hour, minute);
+        break;
+
+      case ModeManager::Mode::HUMIDITY:
+        // Display humidity reading
+        gui_->RenderHumidity(static_cast<uint8_t>(key.first));
+        break;
+
+      case ModeManager::Mode::TEMPERATURE:
+        // Display compensated temperature, offset for calibration
+        gui_->RenderTemperature(static_cast<uint8_t>(key.first));
+        break;
+
+      case ModeManager::Mode::STOPWATCH:
+        gui_->RenderTimeLandscape(key.first / 60, key.first % 60);
+        break;
+
+      case ModeManager::Mode::TIMER:
+        if (landscape) {
+          // Show remaining time in landscape format
+          gui_->RenderTimeLandscapeMS(key.first / 60, key.first % 60);
+        } else if (!key.sand) {
+          // If timer not running, show static time
+          gui_->RenderTimePortraitMS(key.first / 60, key.first % 60);
+        }
+        break;
+
+      default:
+        break;
+    }
+    return true;
+  }
+
+  // Sleep until the next instant the display can change: the next wall-clock
+  // second, the next stopwatch/timer second, or the next sand transfer while
+  // the hourglass runs. Any posted event ends the wait early.
+  void WaitForEvents() {
+    auto now = std::chrono::steady_clock::now();
+    auto wall = std::chrono::system_clock::now();
+    auto deadline =
+        now + (std::chrono::floor<std::chrono::seconds>(wall) +
+               std::chrono::seconds(1) - wall);
+
+    deadline = std::min(deadline, mode_manager_.NextSecondTick(now));
+    if (last_key_.sand) {
+      deadline = std::min(deadline, now + SAND_TRANSFER_PERIOD);
+    }
+
+    // Handlers already applied their state change, draining is enough
+    EventQueue::Event event;
+    if (events_.WaitUntil(deadline, event)) {
+      while (events_.TryPop(event)) {
+      }
+    }
   }
 
   void RunUnitTest() {
@@ -180,11 +258,17 @@ class FluxSand {
       }
 
       auto start = std::chrono::high_resolution_clock::now();
-      Run();  // Run one cycle
+      Render();  // Render one frame
       auto end = std::chrono::high_resolution_clock::now();
       float elapsed =
           std::chrono::duration<float, std::milli>(end - start).count();
-      std::cout << std::format("    → Run() completed in {:.2f} ms\n", elapsed);
+      std::cout << std::format("    → Render() completed in {:.2f} ms\n",
+                               elapsed);
+
+      // Nothing changed, so the second frame must be skipped
+      bool redrawn = Render();
+      std::cout << std::format("    → Unchanged frame {}\n",
+                               redrawn ? "redrawn ❌" : "skipped ✅");
     }
 
     auto t1 = std::chrono::high_resolution_clock::now();
@@ -195,15 +279,47 @@ class FluxSand {
 
  private:
   // Stopwatch control functions
-  void StartStopwatch() { mode_manager_.StartStopwatch(); }
-  void StopStopwatch() { mode_manager_.StopStopwatch(); }
+  void StartStopwatch() {
+    mode_manager_.StartStopwatch();
+    events_.Post(EventQueue::Type::MODE);
+  }
+  void StopStopwatch() {
+    mode_manager_.StopStopwatch();
+    events_.Post(EventQueue::Type::MODE);
+  }
 
   // Timer control functions
   void StartTimer(int duration_sec) {
     mode_manager_.StartTimer(duration_sec);
     gui_->Reset();
+    events_.Post(EventQueue::Type::MODE);
+  }
+  void StopTimer() {
+    mode_manager_.StopTimer();
+    events_.Post(EventQueue::Type::MODE);
+  }
+
+  // Block until the AHRS has left its fast convergence phase and the gyro
+  // bias is in use. Bounded, so a unit without a calibration file (whose
+  // boot calibration takes half a minute) still starts in READY_TIMEOUT.
+  void WaitUntilReady() {
+    auto start = std::chrono::steady_clock::now();
+    while (!(ahrs_->IsConverged() && imu_->IsBiasReady()) &&
+           std::chrono::steady_clock::now() - start < READY_TIMEOUT) {
+      std::this_thread::sleep_for(READY_POLL_PERIOD);
+    }
+    std::cout << std::format(
+        "Ready after {} ms (AHRS {}, gyro bias {})\n",
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count(),
+        ahrs_->IsConverged() ? "converged" : "converging",
+        imu_->IsBiasReady() ? "ready" : "pending");
   }
-  void StopTimer() { mode_manager_.StopTimer(); }
+
+  // Boot readiness bounds
+  static constexpr std::chrono::milliseconds READY_TIMEOUT{6000};
+  static constexpr std::chrono::milliseconds READY_POLL_PERIOD{10};
 
   // Hardware and component pointers
   PWM* pwm_buzzer_;
@@ -215,8 +331,27 @@ class FluxSand {
   Ads1115<2>* ads1115_;
   AHRS* ahrs_;
   InferenceEngine* inference_;
+  Mpu9250* imu_;
+
+  // Inputs of the last rendered frame
+  struct RenderKey {
+    ModeManager::Mode mode;
+    bool landscape;
+    bool sand;  // Hourglass is drawn by the GUI animation thread
+    int64_t first;
+    int64_t second;
+
+    bool operator==(const RenderKey&) const = default;
+  };
+
+  // Sand moves one grain per transfer tick while the hourglass runs
+  static constexpr std::chrono::milliseconds SAND_TRANSFER_PERIOD{25};
+
+  RenderKey last_key_{};
+  bool has_rendered_ = false;
 
   // Application-level modules
+  EventQueue events_;
   ModeManager mode_manager_;
   SensorManager sensor_manager_;
   InferenceHandler inference_handler_;
@@ -3,6 +3,7 @@
 #include "bsp_pwm.hpp"
 #include "comp_gui.hpp"
 #include "comp_inference.hpp"
+#include "event_queue.hpp"
 #include "mode_manager.hpp"
 
 // Handles gesture inference results and maps them to application actions.
@@ -11,18 +12,28 @@ class InferenceHandler {
  public:
   // Initializes the inference handler with required components and callbacks.
   void Init(InferenceEngine* inference, ModeManager* mode_manager,
-            CompGuiX* gui, PWM* buzzer,
+            CompGuiX* gui, PWM* buzzer, EventQueue* events,
             std::function<void(int)> startTimerCallback,
-            std::function<void()> stopTimerCallback) {
+            std::function<void()> stopTimerCallback,
+            std::function<void()> stillCallback) {
     mode_manager_ = mode_manager;
+    events_ = events;
     gui_ = gui;
     buzzer_ = buzzer;
     startTimerCallback_ = std::move(startTimerCallback);
     stopTimerCallback_ = std::move(stopTimerCallback);
+    stillCallback_ = std::move(stillCallback);
 
     // Register a callback to receive gesture inference results
-    inference->RegisterDataCallback([this](ModelOutput result) {
-      std::cout << "New Gesture: " << LABELS.find(result)->second << '\n';
+    // Early results were confident enough to skip the consensus vote
+    inference->SetEarlyMargin(EARLY_MARGIN);
+    inference->RegisterDataCallback([this](const InferenceResult& output) {
+      ModelOutput result = output.gesture;
+      std::cout << "New Gesture: " << LabelOf(result);
+      if (output.early) {
+        std::cout << " (early, margin " << output.margin << ")";
+      }
+      std::cout << '\n';
 
       // Play a confirmation beep when a gesture is detected
       buzzer_->PlayNote(PWM::NoteName::C, 7, 300);
@@ -87,16 +98,32 @@ class InferenceHandler {
           }
           break;
 
+        case ModelOutput::STILL:
+          // Device at rest: a good moment to re-estimate the gyro bias
+          if (stillCallback_) {
+            stillCallback_();
+          }
+          break;
+
         default:
           break;
       }
+
+      // Wake the main loop to show the result
+      events_->Post(EventQueue::Type::GESTURE, static_cast<int32_t>(result));
     });
   }
 
  private:
+  // Top-2 margin at which a run is acted on before consensus; high enough
+  // that only unambiguous runs bypass the vote
+  static constexpr float EARLY_MARGIN = 0.9f;
+
   ModeManager* mode_manager_ = nullptr;          // Mode state handler
   CompGuiX* gui_ = nullptr;                      // GUI interface
   PWM* buzzer_ = nullptr;                        // Buzzer interface
+  EventQueue* events_ = nullptr;                 // Main loop wakeup queue
   std::function<void(int)> startTimerCallback_;  // Callback to start timer
   std::function<void()> stopTimerCallback_;      // Callback to stop timer
+  std::function<void()> stillCallback_;          // Callback on STILL
 };
@@ -6,6 +6,7 @@
 
 #include "bsp_pwm.hpp"
 #include "comp_gui.hpp"
+#include "event_queue.hpp"
 #include "mode_manager.hpp"
 
 // Handles input from physical buttons, including mode switching,
@@ -14,9 +15,11 @@ class InputHandler {
  public:
   // Initialize input handler with hardware references and logic callbacks.
   void Init(Gpio* btn1, Gpio* btn2, PWM* buzzer, CompGuiX* gui,
-            ModeManager* mode_manager, std::function<void()> onStopwatchToggle,
+            ModeManager* mode_manager, EventQueue* events,
+            std::function<void()> onStopwatchToggle,
             std::function<void()> onTimerStop) {
     mode_manager_ = mode_manager;
+    events_ = events;
     gui_ = gui;
     buzzer_ = buzzer;
     onStopwatchToggle_ = std::move(onStopwatchToggle);
@@ -32,6 +35,7 @@ class InputHandler {
       gui_->SandDisable();        // Turn off sand effect
       std::cout << "Button 1\n";
       buzzer_->PlayNote(PWM::NoteName::C, 7, 50);  // Feedback sound
+      events_->Post(EventQueue::Type::BUTTON, 1);   // Redraw new mode
     });
 
     // Configure Button 2 interrupt callback:
@@ -52,6 +56,7 @@ class InputHandler {
         onTimerStop_();       // Stop timer
         gui_->SandDisable();  // Stop sand animation
       }
+      events_->Post(EventQueue::Type::BUTTON, 2);
     });
   }
 
@@ -59,6 +64,7 @@ class InputHandler {
   ModeManager* mode_manager_ = nullptr;  // Pointer to mode manager
   CompGuiX* gui_ = nullptr;              // Pointer to GUI handler
   PWM* buzzer_ = nullptr;                // Pointer to PWM buzzer
+  EventQueue* events_ = nullptr;         // Main loop wakeup queue
 
   std::function<void()> onStopwatchToggle_;  // Callback for stopwatch control
   std::function<void()> onTimerStop_;        // Callback for stopping timer
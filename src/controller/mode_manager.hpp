@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 
@@ -114,6 +115,26 @@ class ModeManager {
   // Get the maximum duration the timer was set to (used for animation ratio).
   int GetMaxTimerDuration() const { return max_duration_sec_; }
 
+  // Steady-clock instant at which the running stopwatch or timer display
+  // next changes, or time_point::max() if neither is running.
+  std::chrono::steady_clock::time_point NextSecondTick(
+      std::chrono::steady_clock::time_point now) const {
+    auto tick_after = [now](std::chrono::steady_clock::time_point start) {
+      return start +
+             std::chrono::duration_cast<std::chrono::seconds>(now - start) +
+             std::chrono::seconds(1);
+    };
+
+    auto next = std::chrono::steady_clock::time_point::max();
+    if (stopwatch_running_) {
+      next = std::min(next, tick_after(stopwatch_start_time_));
+    }
+    if (timer_active_) {
+      next = std::min(next, tick_after(timer_start_time_));
+    }
+    return next;
+  }
+
   // Adjust timer duration (before starting), with clamping.
   void AdjustTimer(int delta_sec) {
     if (!timer_active_) {
@@ -1,13 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <deque>
 #include <functional>
 
 #include "ads1115.hpp"
 #include "aht20.hpp"
 #include "bmp280.hpp"
+#include "comp_filter.hpp"
 #include "comp_gui.hpp"
 
 // Manages environmental sensors and signal processing for temperature,
@@ -33,8 +35,9 @@ class SensorManager {
       constexpr float R0 = 10000.0f;  // Reference resistance at T0
 
       // Convert resistance to temperature in Celsius
-      float temp = 1.0f / (1.0f / T0 + (1.0f / B) * log(r_ntc / R0)) - 273.15f;
-      temperature_ = temp;
+      float temp =
+          1.0f / (1.0f / T0 + (1.0f / B) * std::log(r_ntc / R0)) - 273.15f;
+      temperature_ = temperature_filter_.Push(temp);
     });
 
     // Register callback for channel 1: Photodiode (ambient light sensor)
@@ -44,28 +47,20 @@ class SensorManager {
       float r_photo =
           R_REF * voltage / (VCC - voltage);  // Calculate resistance
 
-      // Empirical constants for light sensor calibration
+      // Empirical constants for light sensor calibration, lux = K / r^1.5
       constexpr float K = 1500000.0f;
-      constexpr float GAMMA = 1.5f;
-      float lux = K / pow(r_photo, GAMMA);  // Convert resistance to lux
-
-      // Maintain a moving average with a deque of last 50 readings
-      light_queue_.push_front(lux);
-      if (light_queue_.size() > 50) {
-        float avg = 0.0f;
-        for (auto l : light_queue_) avg += l;
-        avg /= light_queue_.size();
-        light_ = avg;
-
-        // Reduce GUI update rate using a counter
-        static int counter = 0;
-        if (++counter > 5) {
-          if (gui_) gui_->SetLight(static_cast<uint8_t>(light_ / 20 + 1));
-          counter = 0;
-        }
-
-        // Keep the queue size within limit
-        light_queue_.pop_back();
+      float lux = K / (r_photo * std::sqrt(r_photo));
+
+      // Moving average over the last readings
+      float avg = light_filter_.Push(lux);
+      if (!light_filter_.Full()) {
+        return;
+      }
+      light_ = avg;
+
+      // Only touch the display when the brightness level really changes
+      if (gui_ && brightness_.Update(avg)) {
+        gui_->SetLight(static_cast<uint8_t>(brightness_.Level() + 1));
       }
     });
   }
@@ -85,7 +80,19 @@ class SensorManager {
   }
 
   // Accessor for barometric pressure from BMP280 sensor.
-  float GetPressure() const { return bmp_ ? bmp_->ReadPressure() : 0.0f; }
+  float GetPressure() const { return bmp_ ? bmp_->GetPressure() : 0.0f; }
+
+  // Tell whether a screen showing AHT20 values is visible. The AHT20 is
+  // only sampled at the full rate while one is; otherwise it idles.
+  void SetEnvironmentVisible(bool visible) {
+    if (!aht_ || (has_visibility_ && visible == environment_visible_)) {
+      return;
+    }
+    has_visibility_ = true;
+    environment_visible_ = visible;
+    aht_->SetSamplePeriod(visible ? Aht20::DEFAULT_SAMPLE_PERIOD
+                                  : AHT_IDLE_PERIOD);
+  }
 
  private:
   // Sensor and GUI component references
@@ -93,10 +100,20 @@ class SensorManager {
   Bmp280* bmp_ = nullptr;
   CompGuiX* gui_ = nullptr;
 
-  // Cached sensor values
-  float temperature_ = 0.0f;  // External thermistor temperature
-  float light_ = 0.0f;        // Smoothed ambient light in lux
+  // Cached sensor values, written from the ADS1115 callbacks
+  std::atomic<float> temperature_{0.0f};  // External thermistor temperature
+  std::atomic<float> light_{0.0f};        // Smoothed ambient light in lux
+
+  // Smoothing of the ADS1115 channels
+  MovingAverage<float, 16> temperature_filter_;
+  MovingAverage<float, 50> light_filter_;
+
+  // Display brightness 1..15 in 20 lux steps, a quarter step of hysteresis
+  HysteresisLevel brightness_{20.0f, 0.25f, 0, 14};
+
+  // AHT20 interval while no screen shows its values
+  static constexpr std::chrono::milliseconds AHT_IDLE_PERIOD{10000};
 
-  // Queue for moving average light smoothing
-  std::deque<float> light_queue_;
+  bool has_visibility_ = false;       // SetEnvironmentVisible() called yet
+  bool environment_visible_ = false;  // Humidity/temperature screen shown
 };
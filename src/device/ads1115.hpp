@@ -170,9 +170,7 @@ class Ads1115 {
    * @return ADC result (LSB = 125 µV at ±4.096V)
    */
   int16_t ReadConversion() {
-    uint8_t pointer = POINTER_CONVERSION;
-    i2c_.WriteRaw(&pointer, 1);
-
+    // Pointer write and read go out as one combined transaction
     uint8_t buf[2] = {};
     i2c_.ReadRegisters(POINTER_CONVERSION, buf, 2);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -8,32 +9,45 @@
 #include <thread>
 
 #include "bsp_i2c.hpp"  // I2cDevice class definition
+#include "comp_timer.hpp"
 
 /* AHT20 temperature and humidity sensor driver */
 /* Supports I2C communication and periodic measurement */
+/* A measurement is a small state machine on the shared timer service:
+ * the periodic job sends the trigger command, a one-shot job collects the
+ * result after the conversion time and retries briefly while the sensor
+ * still reports busy. No thread sleeps during a conversion. */
 class Aht20 {
  public:
   /* Default I2C address of AHT20 (0x38) */
   static constexpr uint8_t DEFAULT_I2C_ADDR = 0x38;
 
   /**
-   * Constructor: initialize the sensor and start the measurement thread
+   * Constructor: initialize the sensor and schedule periodic measurements
    *
    * @param i2c Reference to an I2C device
    */
   explicit Aht20(I2cDevice& i2c) : i2c_(i2c) {
     InitSensor();
-    thread_ = std::thread(&Aht20::ThreadFun, this);
+    trigger_timer_ = TimerService::Default().AddPeriodic(
+        sample_period_.load(), [this]() { TriggerMeasurement(); });
   }
 
   /**
-   * Destructor: stop the background thread
+   * Destructor: cancel the measurement timers
+   *
+   * A collect job already past the stopping check may still schedule one
+   * more retry while it is being removed, so keep removing until the
+   * collect timer no longer changes.
    */
   ~Aht20() {
-    running_ = false;
-    if (thread_.joinable()) {
-      thread_.join();
-    }
+    stopping_ = true;
+    TimerService::Default().Remove(trigger_timer_);
+    TimerService::TimerId collect = TimerService::INVALID_TIMER;
+    do {
+      collect = collect_timer_;
+      TimerService::Default().Remove(collect);
+    } while (collect_timer_ != collect);
   }
 
   /**
@@ -50,13 +64,57 @@ class Aht20 {
   /* Get the current humidity value (unit: %RH) */
   float GetHumidity() const { return humidity_; }
 
- private:
-  I2cDevice& i2c_;     /* Reference to I2C device */
-  std::thread thread_; /* Background measurement thread */
-  std::atomic<bool> running_{true};
+  /**
+   * Change the interval between measurements at runtime
+   *
+   * A shorter interval takes a measurement right away so a screen that
+   * asked for faster updates does not show a stale value.
+   *
+   * @param period New interval, at least the conversion time
+   */
+  void SetSamplePeriod(std::chrono::milliseconds period) {
+    period = std::max(period, CONVERSION_TIME + BUSY_RETRY);
+    auto previous = sample_period_.exchange(period);
+    if (period == previous) {
+      return;
+    }
+    TimerService::Default().SetPeriod(
+        trigger_timer_, period,
+        period < previous ? std::chrono::milliseconds(1) : period);
+  }
+
+  /* Current interval between measurements */
+  std::chrono::milliseconds GetSamplePeriod() const { return sample_period_; }
+
+  /* Default interval between measurements */
+  static constexpr std::chrono::milliseconds DEFAULT_SAMPLE_PERIOD{500};
 
-  float temperature_ = 0.0f; /* Current temperature */
-  float humidity_ = 0.0f;    /* Current humidity */
+ private:
+  /* Measurement progress */
+  enum class State : uint8_t {
+    IDLE,      /* Waiting for the next trigger */
+    CONVERTING /* Triggered, result not collected yet */
+  };
+
+  /* Conversion time after the trigger command */
+  static constexpr std::chrono::milliseconds CONVERSION_TIME{80};
+  /* Delay before polling again while the sensor reports busy */
+  static constexpr std::chrono::milliseconds BUSY_RETRY{10};
+  /* Busy polls before the measurement is given up */
+  static constexpr int MAX_BUSY_RETRIES = 5;
+
+  I2cDevice& i2c_; /* Reference to I2C device */
+  TimerService::TimerId trigger_timer_ = TimerService::INVALID_TIMER;
+  std::atomic<TimerService::TimerId> collect_timer_{
+      TimerService::INVALID_TIMER};
+
+  std::atomic<std::chrono::milliseconds> sample_period_{DEFAULT_SAMPLE_PERIOD};
+  std::atomic<State> state_{State::IDLE};
+  std::atomic<bool> stopping_{false}; /* Set first by the destructor */
+  int busy_retries_ = 0; /* Only touched by the collect job */
+
+  std::atomic<float> temperature_{0.0f}; /* Current temperature */
+  std::atomic<float> humidity_{0.0f};    /* Current humidity */
 
   /**
    * Initialize the AHT20 sensor
@@ -69,31 +127,45 @@ class Aht20 {
   }
 
   /**
-   * Thread function: read temperature and humidity every 500ms
+   * Periodic job: start a conversion and collect it once it is done,
+   * without holding a timer worker for the conversion time
    */
-  void ThreadFun() {
-    while (running_) {
-      ReadSensor();
-      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  void TriggerMeasurement() {
+    /* Previous conversion still being collected */
+    State expected = State::IDLE;
+    if (!state_.compare_exchange_strong(expected, State::CONVERTING)) {
+      return;
     }
+
+    const uint8_t CMD[3] = {0xAC, 0x33, 0x00};
+    i2c_.WriteRaw(CMD, 3); /* Send measurement command */
+
+    busy_retries_ = 0;
+    ScheduleCollect(CONVERSION_TIME);
+  }
+
+  void ScheduleCollect(std::chrono::milliseconds delay) {
+    collect_timer_ = TimerService::Default().AddOneShot(
+        delay, [this]() { ReadSensor(); });
   }
 
   /**
    * Read and decode one sample of temperature and humidity
    */
   void ReadSensor() {
-    const uint8_t CMD[3] = {0xAC, 0x33, 0x00};
-    i2c_.WriteRaw(CMD, 3); /* Send measurement command */
-
-    std::this_thread::sleep_for(
-        std::chrono::milliseconds(80)); /* Wait for conversion */
-
     uint8_t buf[6] = {};
-    i2c_.ReadRegisters(0x00, buf, 6); /* Read 6-byte measurement data */
+    i2c_.ReadRaw(buf, 6); /* Read status and 5 measurement bytes */
 
     if ((buf[0] & 0x80) != 0) {
-      return; /* Sensor is busy */
+      /* Sensor is busy: poll again shortly, give up after a few tries */
+      if (!stopping_ && ++busy_retries_ <= MAX_BUSY_RETRIES) {
+        ScheduleCollect(BUSY_RETRY);
+      } else {
+        state_ = State::IDLE;
+      }
+      return;
     }
+    state_ = State::IDLE;
 
     /* Parse humidity */
     uint32_t raw_h = ((buf[1] << 12) | (buf[2] << 4) | (buf[3] >> 4));
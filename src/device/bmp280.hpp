@@ -1,12 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
-#include <thread>
 
 #include "bsp_i2c.hpp"  // Contains I2cDevice class implementation
+#include "comp_timer.hpp"
 
 /**
  * BMP280 temperature and pressure sensor driver
@@ -28,11 +31,49 @@ class Bmp280 {
     REG_CALIB = 0x88       // Calibration data start
   };
 
+  /** Oversampling setting of one measurement (osrs_t / osrs_p) */
+  enum class Oversampling : uint8_t {
+    SKIP = 0,  // Measurement disabled
+    X1 = 1,
+    X2 = 2,
+    X4 = 3,
+    X8 = 4,
+    X16 = 5
+  };
+
+  /** Power mode used for background measurements */
+  enum class Mode : uint8_t {
+    NORMAL,  // Sensor converts continuously, the job only reads
+    FORCED   // Job triggers one conversion per period, sensor sleeps between
+  };
+
+  /** Measurement settings */
+  struct Config {
+    Mode mode = Mode::NORMAL;
+    Oversampling temperature = Oversampling::X1;
+    Oversampling pressure = Oversampling::X1;
+    /** Interval between published readings */
+    std::chrono::milliseconds period{100};
+  };
+
+  /** Compensated values of one measurement */
+  struct Reading {
+    float temperature;  // °C
+    float pressure;     // Pa
+  };
+
   /**
    * Initialize BMP280 with specified I2C device
    * @param i2c Pre-configured I2C device instance
    */
-  Bmp280(I2cDevice& i2c) : i2c_(i2c) {
+  explicit Bmp280(I2cDevice& i2c) : Bmp280(i2c, Config{}) {}
+
+  /**
+   * Initialize BMP280 with specified I2C device and settings
+   * @param i2c Pre-configured I2C device instance
+   * @param config Measurement mode, oversampling and period
+   */
+  Bmp280(I2cDevice& i2c, const Config& config) : i2c_(i2c), config_(config) {
     uint8_t id = i2c_.ReadRegister(REG_ID);
     if (id != 0x58) {  // Verify chip ID
       std::perror("Invalid BMP280 ID");
@@ -41,45 +82,60 @@ class Bmp280 {
     ReadCalibration();
     Configure();
 
-    thread_ = std::thread(&Bmp280::ThreadFun, this);
+    poll_timer_ = TimerService::Default().AddPeriodic(
+        config_.period, [this]() { Poll(); });
+  }
+
+  ~Bmp280() {
+    TimerService::Default().Remove(poll_timer_);
+    TimerService::Default().Remove(collect_timer_);
   }
 
-  void ThreadFun() {
-    while (true) {
-      ReadTemperature();
-      ReadPressure();
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  /**
+   * Periodic measurement, run on the shared timer service. In forced mode
+   * this starts a conversion and collects it once it is done, without
+   * holding a timer worker for the conversion time.
+   */
+  void Poll() {
+    if (config_.mode == Mode::NORMAL) {
+      ReadSensor();
+      return;
     }
+    i2c_.WriteRegister(REG_CTRL_MEAS, CtrlMeas(MODE_FORCED));
+    collect_timer_ = TimerService::Default().AddOneShot(
+        ConversionTime(), [this]() { ReadSensor(); });
   }
 
   void Display() {
-    std::cout << "Temperature: " << ReadTemperature() << " °C\n";
-    std::cout << "Pressure: " << ReadPressure() / 100.0f << " hPa\n";
+    std::cout << "Temperature: " << GetTemperature() << " °C\n";
+    std::cout << "Pressure: " << GetPressure() / 100.0f << " hPa\n";
+  }
+
+  /** Latest temperature and pressure from the same measurement */
+  Reading GetReading() const {
+    return reading_.load(std::memory_order_acquire);
   }
 
   /**
-   * Read compensated temperature in Celsius
+   * Latest compensated temperature; never touches the bus
    * @return Temperature in °C with 0.01°C resolution
    */
-  float ReadTemperature() {
-    int32_t adc_t = ReadRawTemperature();
-    return static_cast<float>(CompensateTemperature(adc_t)) / 100.0f;
-  }
+  float GetTemperature() const { return GetReading().temperature; }
 
   /**
-   * Read compensated pressure in Pascals
+   * Latest compensated pressure; never touches the bus
    * @return Pressure in Pa with 0.01Pa resolution
    */
-  float ReadPressure() {
-    int32_t adc_p = ReadRawPressure();
-    ReadRawTemperature();           // Required to update t_fine
-    CompensateTemperature(adc_t_);  // Ensure t_fine is current
-    return static_cast<float>(CompensatePressure(adc_p)) / 256.0f;
-  }
+  float GetPressure() const { return GetReading().pressure; }
 
  private:
+  /** ctrl_meas power mode bits */
+  static constexpr uint8_t MODE_FORCED = 0b01;
+  static constexpr uint8_t MODE_NORMAL = 0b11;
+
   // NOLINTNEXTLINE
   I2cDevice& i2c_;
+  Config config_;
   int32_t t_fine_ = 0;  // Shared temperature compensation value
 
   // Calibration parameters
@@ -89,16 +145,69 @@ class Bmp280 {
   int16_t dig_p2_, dig_p3_, dig_p4_, dig_p5_, dig_p6_, dig_p7_, dig_p8_,
       dig_p9_;
 
-  int32_t adc_t_ = 0;  // Cached raw temperature value
+  std::atomic<Reading> reading_{Reading{0.0f, 0.0f}};  // Published values
 
-  std::thread thread_;
+  TimerService::TimerId poll_timer_ = TimerService::INVALID_TIMER;
+  std::atomic<TimerService::TimerId> collect_timer_{
+      TimerService::INVALID_TIMER};
 
   /** Configure sensor operating mode */
   void Configure() {
-    // Set oversampling: temp x1, pressure x1, normal mode
-    i2c_.WriteRegister(REG_CTRL_MEAS, 0b00100111);
-    // Set standby time 0.5ms, filter off
-    i2c_.WriteRegister(REG_CONFIG, 0b00000000);
+    // Normal mode converts back to back with the standby time closest to
+    // the period; forced mode sleeps until Poll() triggers a conversion
+    i2c_.WriteRegister(REG_CONFIG, static_cast<uint8_t>(StandbyBits() << 5));
+    i2c_.WriteRegister(REG_CTRL_MEAS,
+                       config_.mode == Mode::NORMAL ? CtrlMeas(MODE_NORMAL)
+                                                    : CtrlMeas(0));
+  }
+
+  uint8_t CtrlMeas(uint8_t mode) const {
+    return static_cast<uint8_t>(
+        (static_cast<uint8_t>(config_.temperature) << 5) |
+        (static_cast<uint8_t>(config_.pressure) << 2) | mode);
+  }
+
+  /** Longest t_sb not above the period (0.5 ms to 4 s), filter off */
+  uint8_t StandbyBits() const {
+    constexpr float STANDBY_MS[] = {0.5f,   62.5f,  125.0f,  250.0f,
+                                    500.0f, 1000.0f, 2000.0f, 4000.0f};
+    uint8_t bits = 0;
+    for (uint8_t i = 0; i < std::size(STANDBY_MS); ++i) {
+      if (STANDBY_MS[i] <= static_cast<float>(config_.period.count())) {
+        bits = i;
+      }
+    }
+    return bits;
+  }
+
+  /** Maximum conversion time for the configured oversampling (datasheet
+   * 3.8.1), rounded up */
+  std::chrono::milliseconds ConversionTime() const {
+    auto samples = [](Oversampling os) {
+      return os == Oversampling::SKIP
+                 ? 0.0f
+                 : static_cast<float>(1 << (static_cast<int>(os) - 1));
+    };
+    float ms = 1.25f + 2.3f * samples(config_.temperature);
+    if (config_.pressure != Oversampling::SKIP) {
+      ms += 2.3f * samples(config_.pressure) + 0.575f;
+    }
+    return std::chrono::milliseconds(static_cast<int>(std::ceil(ms)));
+  }
+
+  /** Burst-read pressure and temperature and publish both */
+  void ReadSensor() {
+    uint8_t data[6];
+    i2c_.ReadRegisters(REG_PRESS_MSB, data, 6);
+    int32_t adc_p = (data[0] << 12) | (data[1] << 4) | (data[2] >> 4);
+    int32_t adc_t = (data[3] << 12) | (data[4] << 4) | (data[5] >> 4);
+
+    // Temperature first: it updates t_fine for the pressure formula
+    Reading reading;
+    reading.temperature =
+        static_cast<float>(CompensateTemperature(adc_t)) / 100.0f;
+    reading.pressure = static_cast<float>(CompensatePressure(adc_p)) / 256.0f;
+    reading_.store(reading, std::memory_order_release);
   }
 
   /** Read and store calibration data from sensor */
@@ -123,21 +232,6 @@ class Bmp280 {
     dig_p9_ = static_cast<int16_t>((buf[23] << 8) | buf[22]);
   }
 
-  /** Read raw temperature ADC value */
-  int32_t ReadRawTemperature() {
-    uint8_t data[3];
-    i2c_.ReadRegisters(REG_TEMP_MSB, data, 3);
-    adc_t_ = (data[0] << 12) | (data[1] << 4) | (data[2] >> 4);
-    return adc_t_;
-  }
-
-  /** Read raw pressure ADC value */
-  int32_t ReadRawPressure() {
-    uint8_t data[3];
-    i2c_.ReadRegisters(REG_PRESS_MSB, data, 3);
-    return (data[0] << 12) | (data[1] << 4) | (data[2] >> 4);
-  }
-
   /** Temperature compensation algorithm */
   int32_t CompensateTemperature(int32_t adc_T) {
     int32_t var1 = (((adc_T >> 3) - (static_cast<int32_t>(dig_t1_) << 1)) *
@@ -6,13 +6,17 @@
 #include <unistd.h>
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
 
 #include "bsp_gpio.hpp"
 #include "bsp_spi.hpp"
+#include "comp_metrics.hpp"
+#include "comp_timer.hpp"
 
 /* MAX7219 LED matrix driver controller template class
  * N: Number of cascaded MAX7219 chips */
@@ -29,34 +33,73 @@ class Max7219 {
   static constexpr uint8_t REG_SHUTDOWN = 0x0C;
   static constexpr uint8_t REG_DISPLAY_TEST = 0x0F;
 
-  /* Constructor: Initialize SPI and CS (Chip Select) pin */
-  Max7219(SpiDevice& spi, Gpio* cs) : spi_(spi), cs_(cs) {
-    if (!cs_) {
-      std::perror("CS GPIO is not initialized");
+  /* Interval between refresh passes */
+  static constexpr std::chrono::milliseconds REFRESH_PERIOD{5};
+
+  /* Constructor: Initialize SPI and CS (Chip Select) pin
+   * cs: GPIO chip select, or nullptr to let the kernel drive CS. The kernel
+   *     path batches a whole frame into one ioctl and requires the CS line
+   *     to belong to the spidev node, e.g. in /boot/firmware/config.txt:
+   *     dtoverlay=spi1-1cs,cs0_pin=26
+   * self_test: draw the diagnostic pattern before returning (~1 s) */
+  Max7219(SpiDevice& spi, Gpio* cs, bool self_test = true)
+      : spi_(spi), cs_(cs) {
+    if (cs_) {
+      cs_->Write(1); /* CS active low, initialize to high */
     }
-    cs_->Write(1); /* CS active low, initialize to high */
     for (auto& chip : framebuffer_) {
       chip.fill(0); /* Clear frame buffer */
     }
 
-    thread_ = std::thread(&Max7219::RefreshThread, this);
+    Initialize();
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    /* Refresh on the shared timer service with a fixed 5 ms cadence */
+    refresh_timer_ = TimerService::Default().AddPeriodic(
+        REFRESH_PERIOD, [this]() { Refresh(); });
 
-    TestEachChip();
+    if (self_test) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      TestEachChip();
+    }
   }
 
-  void RefreshThread() {
-    Initialize();
+  ~Max7219() { TimerService::Default().Remove(refresh_timer_); }
 
-    while (true) {
-      Refresh();
-      std::this_thread::sleep_for(std::chrono::milliseconds(5));
-    }
+  /* Stop the periodic refresh job, waiting for a running pass to finish.
+   * The owner then calls Refresh() itself, e.g. on a replay's virtual
+   * clock. */
+  void StopRefreshTimer() {
+    TimerService::Default().Remove(refresh_timer_);
+    refresh_timer_ = TimerService::INVALID_TIMER;
   }
 
   /* Initialize all cascaded chips */
   void Initialize() {
+    if (!cs_) {
+      /* Same sequence on every chip, one latched command per transfer */
+      static constexpr std::array<std::array<uint8_t, 2>, 6> INIT_SEQUENCE = {{
+          {REG_SHUTDOWN, 0x00},     /* Enter shutdown mode */
+          {REG_DISPLAY_TEST, 0x00}, /* Normal operation */
+          {REG_DECODE_MODE, 0x00},  /* Matrix mode (no decoding) */
+          {REG_SCAN_LIMIT, 0x07},   /* Scan all 8 rows */
+          {REG_INTENSITY, 0x03},    /* Medium brightness */
+          {REG_SHUTDOWN, 0x01},     /* Normal operation */
+      }};
+      std::array<std::array<uint8_t, N * 2>, INIT_SEQUENCE.size()> tx_bufs;
+      std::array<spi_ioc_transfer, INIT_SEQUENCE.size()> transfers;
+      for (size_t k = 0; k < INIT_SEQUENCE.size(); ++k) {
+        std::array<uint8_t, N> regs;
+        std::array<uint8_t, N> data;
+        regs.fill(INIT_SEQUENCE[k][0]);
+        data.fill(INIT_SEQUENCE[k][1]);
+        PrepareTransfer(regs, data, tx_bufs[k], transfers[k]);
+      }
+      SendBatch(transfers.data(), transfers.size());
+      Invalidate(); /* Chip contents unknown after init */
+      Refresh();
+      return;
+    }
+
     for (size_t i = 0; i < N; ++i) {
       WriteToChip(i, REG_SHUTDOWN, 0x00);     /* Enter shutdown mode */
       usleep(5);                              /* Short delay */
@@ -66,18 +109,18 @@ class Max7219 {
       WriteToChip(i, REG_INTENSITY, 0x03);    /* Medium brightness */
       WriteToChip(i, REG_SHUTDOWN, 0x01);     /* Normal operation */
     }
-    Clear();
+    Invalidate(); /* Chip contents unknown after init */
     Refresh();
   }
 
-  /* Set global brightness (0-15) */
+  /* Set global brightness (0-15)
+   * Applied by the refresh job before its next frame, so callers never
+   * wait for the SPI bus. */
   void SetIntensity(uint8_t value) {
-    mutex_.lock();
     if (value > 0x0F) {
       value = 0x0F;
     }
-    WriteAll(REG_INTENSITY, value);
-    mutex_.unlock();
+    pending_intensity_.store(value, std::memory_order_relaxed);
   }
 
   /* Clear frame buffer */
@@ -102,39 +145,144 @@ class Max7219 {
     }
   }
 
-  /* 16x32 composite matrix drawing function
-   * Handles coordinate mapping for 4x2 matrix layout */
-  void DrawPixelMatrix2(uint8_t row, uint8_t col, bool on) {
-    if (row >= 16 || col >= 32) {
+  /* Set a whole row of one chip at once
+   * chip_index: Chip index (0-based)
+   * row: Vertical position (0-7)
+   * bits: Bit n lights column n */
+  void DrawRow(size_t chip_index, uint8_t row, uint8_t bits) {
+    if (chip_index >= N || row >= 8) {
       return;
     }
+    framebuffer_[chip_index][7 - row] = bits;
+  }
+
+  /* OR bits into a row of one chip, for blitting precomputed masks
+   * chip_index: Chip index (0-based)
+   * row: Vertical position (0-7)
+   * bits: Bit n lights column n */
+  void OrRow(size_t chip_index, uint8_t row, uint8_t bits) {
+    if (chip_index >= N || row >= 8) {
+      return;
+    }
+    framebuffer_[chip_index][7 - row] |= bits;
+  }
+
+  /* Chip-local position of a composite matrix pixel */
+  struct ChipPixel {
+    uint8_t chip;
+    uint8_t row;
+    uint8_t col;
+  };
 
+  /* Coordinate mapping for the 4x2 matrix layout, usable at compile time
+   * row: 0-15, col: 0-31 */
+  static constexpr ChipPixel MapMatrix2(uint8_t row, uint8_t col) {
     /* Serpentine layout chip index mapping */
-    static constexpr int CHIP_INDEX_MAP[] = {0, 2, 1, 3};
+    constexpr uint8_t CHIP_INDEX_MAP[] = {0, 2, 1, 3};
 
     /* Calculate chip position in virtual matrix */
     size_t chip_index = (row / 8) + (col / 8) * 2;
     /* Apply physical layout mapping */
     chip_index = CHIP_INDEX_MAP[chip_index % 4] + (chip_index - chip_index % 4);
-    uint8_t local_row = row % 8;
-    uint8_t local_col = col % 8;
 
-    DrawPixel(chip_index, local_row, local_col, on);
+    return {static_cast<uint8_t>(chip_index), static_cast<uint8_t>(row % 8),
+            static_cast<uint8_t>(col % 8)};
+  }
+
+  /* 16x32 composite matrix drawing function
+   * Handles coordinate mapping for 4x2 matrix layout */
+  void DrawPixelMatrix2(uint8_t row, uint8_t col, bool on) {
+    if (row >= 16 || col >= 32) {
+      return;
+    }
+
+    ChipPixel pixel = MapMatrix2(row, col);
+    DrawPixel(pixel.chip, pixel.row, pixel.col, on);
   }
 
-  /* Refresh display with current buffer */
+  /* Refresh counters */
+  struct RefreshStats {
+    uint64_t rows_sent;      /* Rows transmitted to the chain */
+    uint64_t rows_skipped;   /* Rows unchanged on every chip */
+    uint64_t frames_skipped; /* Refresh calls with nothing to send */
+  };
+
+  /* Refresh display with the latest published frame (refresh job only)
+   * Only rows that differ from the last transmitted frame are sent; chips
+   * whose row is unchanged get a NOOP in that transfer. */
   void Refresh() {
-    mutex_.lock();
+    ScopedLatency latency(Metrics::Stage::SPI_REFRESH);
+    std::array<std::array<uint8_t, N * 2>, 8> tx_bufs;
+    std::array<spi_ioc_transfer, 8> transfers;
+
+    int intensity = pending_intensity_.exchange(-1, std::memory_order_relaxed);
+    if (intensity >= 0) {
+      WriteAll(REG_INTENSITY, static_cast<uint8_t>(intensity));
+    }
+
+    /* Take the newest complete frame, if any was published */
+    if (middle_.load(std::memory_order_relaxed) & FRESH) {
+      front_ =
+          middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    const Frame& frame = frames_[front_];
+    const bool RESEND =
+        !shadow_valid_.exchange(true, std::memory_order_relaxed);
+
+    size_t sent = 0;
     for (uint8_t row = 0; row < 8; ++row) {
       std::array<uint8_t, N> regs;
       std::array<uint8_t, N> data;
-      regs.fill(REG_DIGIT0 + row);
+      bool dirty = false;
       for (size_t i = 0; i < N; ++i) {
-        data[i] = framebuffer_[i][row];
+        if (RESEND || frame[i][row] != shadow_[i][row]) {
+          regs[i] = REG_DIGIT0 + row;
+          data[i] = frame[i][row];
+          shadow_[i][row] = frame[i][row];
+          dirty = true;
+        } else {
+          regs[i] = REG_NOOP;
+          data[i] = 0x00;
+        }
+      }
+      if (!dirty) {
+        continue;
+      }
+      if (cs_) {
+        WriteCommandRaw(regs, data);
+      } else {
+        PrepareTransfer(regs, data, tx_bufs[sent], transfers[sent]);
       }
-      WriteCommandRaw(regs, data);
+      sent++;
+    }
+
+    /* Kernel CS: the whole frame goes out in one ioctl */
+    if (!cs_) {
+      SendBatch(transfers.data(), sent);
+    }
+
+    rows_sent_.fetch_add(sent, std::memory_order_relaxed);
+    rows_skipped_.fetch_add(8 - sent, std::memory_order_relaxed);
+    if (sent == 0) {
+      frames_skipped_.fetch_add(1, std::memory_order_relaxed);
     }
-    mutex_.unlock();
+  }
+
+  /* Force the next Refresh to resend every row */
+  void Invalidate() { shadow_valid_.store(false, std::memory_order_relaxed); }
+
+  /* Read refresh counters */
+  RefreshStats GetRefreshStats() const {
+    return {rows_sent_.load(std::memory_order_relaxed),
+            rows_skipped_.load(std::memory_order_relaxed),
+            frames_skipped_.load(std::memory_order_relaxed)};
+  }
+
+  /* Reset refresh counters */
+  void ResetRefreshStats() {
+    rows_sent_.store(0, std::memory_order_relaxed);
+    rows_skipped_.store(0, std::memory_order_relaxed);
+    frames_skipped_.store(0, std::memory_order_relaxed);
   }
 
   /* Write to specific chip */
@@ -153,62 +301,74 @@ class Max7219 {
 
   /* Full diagnostic test pattern */
   void TestEachChip() {
+    std::lock_guard<std::mutex> lock(render_mutex_);
     Clear();
     /* Draw left border */
     for (int i = 0; i < 16; ++i) {
       DrawPixelMatrix2(i, 0, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw bottom border */
     for (int i = 0; i < 16; ++i) {
       DrawPixelMatrix2(15, i, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw middle vertical line */
     for (int i = 0; i < 16; ++i) {
       DrawPixelMatrix2(i, 16, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw right border */
     for (int i = 16; i < 32; ++i) {
       DrawPixelMatrix2(15, i, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw right vertical line */
     for (int i = 15; i > 0; --i) {
       DrawPixelMatrix2(i, 31, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw top right border */
     for (int i = 31; i > 16; --i) {
       DrawPixelMatrix2(0, i, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw middle horizontal line */
     for (int i = 15; i > 0; --i) {
       DrawPixelMatrix2(i, 15, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
 
     /* Draw top left border */
     for (int i = 15; i > 0; --i) {
       DrawPixelMatrix2(0, i, true);
+      Publish();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
   }
   
-  void Lock(){
-    mutex_.lock();
-  }
-  
-  void Unlock(){
-    mutex_.unlock();
+  /* Start drawing a frame
+   * Renderers serialize on this; the canvas keeps the previous frame, so
+   * partial updates work as before. */
+  void BeginFrame() { render_mutex_.lock(); }
+
+  /* Hand the drawn frame to the refresh job and end drawing */
+  void PublishFrame() {
+    Publish();
+    render_mutex_.unlock();
   }
   
   void SetLight(uint8_t light){
@@ -219,10 +379,41 @@ class Max7219 {
   // NOLINTNEXTLINE
   SpiDevice& spi_;
   Gpio* cs_;
-  std::array<std::array<uint8_t, 8>, N> framebuffer_;
-  std::thread thread_; /* Thread */
-  std::mutex mutex_;
+
+  using Frame = std::array<std::array<uint8_t, 8>, N>;
+
+  /* Renderer canvas, guarded by render_mutex_ */
+  Frame framebuffer_;
+  std::mutex render_mutex_;
+
+  /* Triple buffer between renderers and the refresh job: renderers fill
+   * frames_[back_], the refresh job reads frames_[front_], and middle_
+   * holds the latest complete frame, FRESH while not yet picked up. */
+  static constexpr uint8_t FRESH = 0x80;
+  static constexpr uint8_t INDEX_MASK = 0x03;
+  std::array<Frame, 3> frames_{};
+  uint8_t back_ = 1;
+  uint8_t front_ = 0;
+  std::atomic<uint8_t> middle_{2};
+
+  /* Refresh thread state */
+  Frame shadow_{};                         /* Last frame sent */
+  std::atomic<bool> shadow_valid_{false};  /* shadow_ matches the chips */
+  std::atomic<int> pending_intensity_{-1}; /* Brightness to apply, or -1 */
+  TimerService::TimerId refresh_timer_ = TimerService::INVALID_TIMER;
+
+  std::atomic<uint64_t> rows_sent_{0};
+  std::atomic<uint64_t> rows_skipped_{0};
+  std::atomic<uint64_t> frames_skipped_{0};
   
+  /* Copy the canvas into the back buffer and swap it in as the latest
+   * frame; never blocks the refresh job */
+  void Publish() {
+    frames_[back_] = framebuffer_;
+    back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) &
+            INDEX_MASK;
+  }
+
   /* Write to all chips with same register */
   void WriteAll(uint8_t addr, uint8_t value) {
     std::array<uint8_t, N> data;
@@ -237,22 +428,44 @@ class Max7219 {
     WriteCommandRaw(regs, data);
   }
 
-  /* Low-level SPI write operation */
-  void WriteCommandRaw(const std::array<uint8_t, N>& regs,
-                       const std::array<uint8_t, N>& data) {
-    std::array<uint8_t, N * 2> tx_buf{};
+  /* Fill one chain-wide transfer (one register/data pair per chip) */
+  static void PrepareTransfer(const std::array<uint8_t, N>& regs,
+                              const std::array<uint8_t, N>& data,
+                              std::array<uint8_t, N * 2>& tx_buf,
+                              spi_ioc_transfer& transfer) {
     for (size_t i = 0; i < N; ++i) {
       const size_t HW_INDEX = N - 1 - i;
       tx_buf[i * 2] = regs[HW_INDEX];
       tx_buf[i * 2 + 1] = data[HW_INDEX];
     }
 
-    spi_ioc_transfer transfer{};
+    transfer = {};
     transfer.tx_buf = reinterpret_cast<uint64_t>(tx_buf.data());
     transfer.len = tx_buf.size();
     transfer.speed_hz = 1000000;
     transfer.bits_per_word = 8;
     transfer.delay_usecs = 10;
+  }
+
+  /* Send transfers in one ioctl, releasing CS between them so each latches */
+  void SendBatch(spi_ioc_transfer* transfers, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      transfers[i].cs_change = (i + 1 < count) ? 1 : 0;
+    }
+    spi_.TransferBatch(transfers, count);
+  }
+
+  /* Low-level SPI write operation */
+  void WriteCommandRaw(const std::array<uint8_t, N>& regs,
+                       const std::array<uint8_t, N>& data) {
+    std::array<uint8_t, N * 2> tx_buf{};
+    spi_ioc_transfer transfer{};
+    PrepareTransfer(regs, data, tx_buf, transfer);
+
+    if (!cs_) {
+      SendBatch(&transfer, 1);
+      return;
+    }
 
     usleep(100);
     cs_->Write(0);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -8,13 +9,20 @@
 #include <format>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include <thread>
 
 #include "bsp_gpio.hpp"
 #include "bsp_spi.hpp"
+#include "bsp_thread.hpp"
+#include "comp_metrics.hpp"
+#include "comp_timer.hpp"
 #include "comp_type.hpp"
 
 /**
@@ -24,90 +32,109 @@
  */
 class Mpu9250 {
  public:
+  /** How samples are taken off the chip */
+  enum class Mode : uint8_t {
+    INTERRUPT, /* One SPI read per data-ready edge */
+    FIFO       /* Periodic burst drain of the on-chip FIFO */
+  };
+
   /**
    * Constructor
    *
    * @param spi_device Pointer to an SPI device object
    * @param gpio_cs    Pointer to a GPIO object (chip select)
+   * @param gpio_int   Pointer to a GPIO object (data-ready interrupt)
+   * @param mode       Sample acquisition mode
    */
-  Mpu9250(SpiDevice* spi_device, Gpio* gpio_cs, Gpio* gpio_int)
-      : spi_device_(spi_device), gpio_cs_(gpio_cs), gpio_int_(gpio_int) {
+  Mpu9250(SpiDevice* spi_device, Gpio* gpio_cs, Gpio* gpio_int,
+          Mode mode = Mode::INTERRUPT)
+      : spi_device_(spi_device),
+        gpio_cs_(gpio_cs),
+        gpio_int_(gpio_int),
+        mode_(mode) {
     assert(spi_device_ && gpio_cs_ && gpio_int_);
 
     Initialize();
     LoadCalibrationData();
 
-    /* Register interrupt callback */
-    gpio_int_->EnableInterruptRisingEdgeWithCallback([this]() { ReadData(); });
+    if (mode_ == Mode::FIFO) {
+      /* Drain on a private service so the job runs on the realtime core */
+      fifo_timers_ = std::make_unique<TimerService>(1, "imu",
+                                                    ThreadConfig::Role::IMU);
+      fifo_timer_ = fifo_timers_->AddPeriodic(FIFO_DRAIN_PERIOD,
+                                              [this]() { DrainFifo(); });
+    } else {
+      /* Register interrupt callback on a private loop, so the data-ready
+       * handler runs on the realtime core apart from buttons and ADC */
+      irq_loop_ = std::make_unique<GpioEventLoop>(ThreadConfig::Role::IMU);
+      gpio_int_->EnableInterruptRisingEdgeWithCallback(
+          [this]() { ReadData(); }, *irq_loop_);
+    }
 
-    calibrate_thread_ = std::thread(&Mpu9250::CalibrateThreadTask, this);
+    /* Boot calibration: wait for the device to rest, however long */
+    RequestCalibration(true);
   }
 
   ~Mpu9250() {
-    if (calibrate_thread_.joinable()) {
-      calibrate_thread_.join();
+    TimerService::Default().Remove(save_timer_);
+    if (fifo_timers_) {
+      fifo_timers_->Remove(fifo_timer_);
+    }
+    if (irq_loop_) {
+      gpio_int_->DisableInterrupt();
     }
   }
 
-  void CalibrateThreadTask() {
-    while (true) {
-      auto start_time = std::chrono::steady_clock::now();
-      std::chrono::microseconds period_us(1000);
-      std::chrono::steady_clock::time_point next_time =
-          std::chrono::steady_clock::now();
-      uint32_t counter = 0;
-      double gyro_offset_x = 0, gyro_offset_y = 0, gyro_offset_z = 0;
-      static bool cali_done = false;
-
-      if (cali_done) {
-        std::this_thread::sleep_for(std::chrono::seconds(UINT32_MAX));
-        continue;
-      }
+  /** Outcome of one gyro calibration session */
+  struct CalibrationResult {
+    enum class Status : uint8_t {
+      APPLIED,   /* Bias updated and saved */
+      UNCHANGED, /* Residual bias below the threshold */
+      ABORTED    /* Device moved before enough samples were collected */
+    };
 
-      while (true) {
-        if (std::fabsf(gyro_delta_.x) > 0.005 ||
-            std::fabsf(gyro_delta_.y) > 0.005 ||
-            std::fabsf(gyro_delta_.z) > 0.01) {
-          next_time += period_us;
-          std::this_thread::sleep_until(next_time);
-          break;
-        }
-
-        auto now = std::chrono::steady_clock::now();
-        if (now - start_time > std::chrono::seconds(5) &&
-            now - start_time < std::chrono::seconds(30)) {
-          counter++;
-          gyro_offset_x += gyro_.x;
-          gyro_offset_y += gyro_.y;
-          gyro_offset_z += gyro_.z;
-        }
-
-        if (now - start_time > std::chrono::seconds(35) && cali_done == false) {
-          float bias_x =
-              static_cast<float>(gyro_offset_x / static_cast<double>(counter));
-          float bias_y =
-              static_cast<float>(gyro_offset_y / static_cast<double>(counter));
-          float bias_z =
-              static_cast<float>(gyro_offset_z / static_cast<double>(counter));
-
-          if (std::fabsf(bias_x) > 0.005 || std::fabsf(bias_y) > 0.005 ||
-              std::fabsf(bias_z) > 0.005) {
-            gyro_bias_.x += bias_x;
-            gyro_bias_.y += bias_y;
-            gyro_bias_.z += bias_z;
-            SaveCalibrationData();
-            std::cout << "Calibration data saved\n";
-          } else {
-            std::cout << "No need to calibrate\n";
-          }
-          cali_done = true;
-          std::cout << "Calibration completed\n";
-        }
-
-        next_time += period_us;
-        std::this_thread::sleep_until(next_time);
-      }
+    Status status;
+    Type::Vector3 bias;  /* Gyro bias in use after the session */
+    Type::Vector3 noise; /* Gyro standard deviation while at rest */
+    uint32_t samples;    /* Samples averaged */
+  };
+
+  /**
+   * Starts a gyro bias calibration on the sample stream.
+   *
+   * Samples are averaged with a running mean/variance once the device has
+   * been at rest for CALI_WARMUP_SAMPLES, until CALI_COLLECT_SAMPLES are in.
+   * A request while a session is running returns that session's future.
+   *
+   * @param restart_on_motion Restart the window when the device moves
+   *                          instead of aborting the session
+   * @return Future resolved from the sample thread when the session ends
+   */
+  std::shared_future<CalibrationResult> RequestCalibration(
+      bool restart_on_motion = false) {
+    std::lock_guard<std::mutex> lock(cali_mutex_);
+    if (!cali_pending_) {
+      cali_promise_ = std::promise<CalibrationResult>();
+      cali_future_ = cali_promise_.get_future().share();
+      cali_pending_ = true;
+      cali_restart_on_motion_ = restart_on_motion;
+      cali_requested_.store(true, std::memory_order_release);
     }
+    return cali_future_;
+  }
+
+  /**
+   * True once a gyro bias is in use: loaded from the calibration file or
+   * measured by a completed calibration session.
+   */
+  bool IsBiasReady() const {
+    return bias_ready_.load(std::memory_order_acquire);
+  }
+
+  /** Future of the latest calibration session */
+  std::shared_future<CalibrationResult> GetCalibrationFuture() {
+    std::lock_guard<std::mutex> lock(cali_mutex_);
+    return cali_future_;
   }
 
   /**
@@ -122,6 +149,23 @@ class Mpu9250 {
     data_callback_ = callback;
   }
 
+  /**
+   * @brief Registers a callback receiving every drained FIFO batch at once.
+   *
+   * The span points into an internal buffer and is only valid during the
+   * call. In FIFO mode the per-sample callback is still invoked for each
+   * sample after this one.
+   *
+   * @param callback The callback function
+   */
+  void RegisterBatchCallback(
+      const std::function<void(std::span<const Type::ImuSample>)>& callback) {
+    batch_callback_ = callback;
+  }
+
+  /** Number of times the FIFO filled up and had to be reset */
+  uint32_t GetFifoOverflowCount() const { return fifo_overflows_.load(); }
+
   /**
    * Initializes MPU9250 settings.
    *
@@ -129,16 +173,26 @@ class Mpu9250 {
    * I2C Master mode for the magnetometer, and performs a WHO_AM_I check.
    */
   void Initialize() {
-    /* Reset and wake up the MPU9250 */
+    /* Reset and wake up the MPU9250. Registers read as 0x00 while the
+     * reset is in progress, so H_RESET alone cannot tell when it is done:
+     * wait the typical start-up time, then poll WHO_AM_I until the chip
+     * answers, up to the 100 ms worst case */
     spi_device_->WriteRegister(gpio_cs_, PWR_MGMT_1, 0x80);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto reset_deadline = std::chrono::steady_clock::now() + RESET_TIMEOUT;
+    std::this_thread::sleep_for(RESET_MIN_DELAY);
 
-    /* Read and verify WHO_AM_I register */
     uint8_t who_am_i = spi_device_->ReadRegister(gpio_cs_, WHO_AM_I);
+    while (!IsKnownId(who_am_i) &&
+           std::chrono::steady_clock::now() < reset_deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      who_am_i = spi_device_->ReadRegister(gpio_cs_, WHO_AM_I);
+    }
+
+    /* Verify WHO_AM_I register */
     std::cout << std::format("MPU9250 initialized. WHO_AM_I: 0x{:02X}\n",
                              who_am_i);
 
-    if (who_am_i != 0x71 && who_am_i != 0x68 && who_am_i != 0x70) {
+    if (!IsKnownId(who_am_i)) {
       std::perror(
           std::format("Error: MPU9250 connection failed (WHO_AM_I: 0x{:02X})",
                       who_am_i)
@@ -153,8 +207,9 @@ class Mpu9250 {
 
     /* INT high level, push-pull */
     spi_device_->WriteRegister(gpio_cs_, INT_PIN_CFG, 0x10);
-    /* enable data ready interrupt */
-    spi_device_->WriteRegister(gpio_cs_, INT_ENABLE, 0x01);
+    /* Enable data ready interrupt, not needed when draining the FIFO */
+    spi_device_->WriteRegister(gpio_cs_, INT_ENABLE,
+                               mode_ == Mode::FIFO ? 0x00 : 0x01);
 
     spi_device_->WriteRegister(gpio_cs_, I2C_MST_CTRL, 0x4D);
 
@@ -189,58 +244,146 @@ class Mpu9250 {
     /* Configure AK8963 magnetometer for continuous measurement mode 1. */
     WriteMagRegister(AK8963_CNTL1_REG, 0x12);
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    if (mode_ == Mode::FIFO) {
+      ResetFifo();
+    }
   }
 
   /**
-   * Reads sensor data for acceleration and gyroscope.
+   * Clears the FIFO and restarts capturing accel + gyro into it.
    */
-  void ReadData() {
-    std::array<uint8_t, 14> data{};
+  void ResetFifo() {
+    spi_device_->WriteRegister(gpio_cs_, FIFO_EN, 0x00);
+    spi_device_->WriteRegister(gpio_cs_, USER_CTRL,
+                               USER_CTRL_I2C_MST_EN | USER_CTRL_FIFO_RST);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    spi_device_->WriteRegister(gpio_cs_, USER_CTRL,
+                               USER_CTRL_I2C_MST_EN | USER_CTRL_FIFO_EN);
+    /* Gyro X/Y/Z and accel, 12 bytes per sample */
+    spi_device_->WriteRegister(gpio_cs_, FIFO_EN, 0x78);
+  }
+
+  /**
+   * Drains the FIFO in one burst read and delivers the samples.
+   *
+   * Samples are timestamped backwards from the read time at the configured
+   * sample period. On overflow the FIFO content is no longer frame-aligned,
+   * so it is discarded and the FIFO restarted.
+   *
+   * @return Number of samples delivered
+   */
+  size_t DrainFifo() {
+    const auto START = std::chrono::steady_clock::now();
+    auto count_data = spi_device_->ReadRegisters<2>(gpio_cs_, FIFO_COUNT_H);
+    size_t count = ((count_data[0] & 0x1F) << 8) | count_data[1];
+
+    if (count >= FIFO_SIZE - FIFO_SAMPLE_BYTES) {
+      fifo_overflows_.fetch_add(1, std::memory_order_relaxed);
+      ResetFifo();
+      return 0;
+    }
+
+    size_t samples = count / FIFO_SAMPLE_BYTES;
+    if (samples == 0) {
+      return 0;
+    }
+
+    auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+
+    spi_device_->ReadRegisters(
+        gpio_cs_, FIFO_R_W,
+        std::span(fifo_raw_).first(samples * FIFO_SAMPLE_BYTES));
+
+    for (size_t i = 0; i < samples; ++i) {
+      const uint8_t* frame = &fifo_raw_[i * FIFO_SAMPLE_BYTES];
+      Type::ImuSample& sample = fifo_samples_[i];
+      DecodeSample(frame, frame + 6, sample.accel, sample.gyro);
+      sample.timestamp_us = static_cast<uint64_t>(now_us) -
+                            (samples - 1 - i) * SAMPLE_PERIOD_US;
+      FeedCalibration(sample.gyro);
+    }
+
+    std::span<const Type::ImuSample> batch(fifo_samples_.data(), samples);
+    Metrics::Default().Latency(Metrics::Stage::IMU_READ).RecordSince(START);
+
+    accel_ = batch.back().accel;
+    gyro_ = batch.back().gyro;
+
+    if (batch_callback_) {
+      batch_callback_(batch);
+    }
 
-    spi_device_->ReadRegisters(gpio_cs_, ACCEL_XOUT_H, &data[0], 14);
+    if (data_callback_) {
+      for (const auto& sample : batch) {
+        data_callback_(sample.accel, sample.gyro);
+      }
+    }
 
+    return samples;
+  }
+
+  /**
+   * Converts raw big-endian accel and gyro registers to body-frame vectors.
+   *
+   * @param accel_data 6 bytes starting at ACCEL_XOUT_H
+   * @param gyro_data  6 bytes starting at GYRO_XOUT_H
+   * @param accel      Acceleration output in m/s^2
+   * @param gyro       Angular rate output in rad/s with bias removed
+   */
+  void DecodeSample(const uint8_t* accel_data, const uint8_t* gyro_data,
+                    Type::Vector3& accel, Type::Vector3& gyro) const {
     constexpr float ACCEL_SCALE = 16.0f / 32768.0f * 9.80665f;
     constexpr float GYRO_SCALE = 2000.0f / 32768.0f * M_PI / 180.0f;
 
+    accel.z = static_cast<float>(
+                  static_cast<int16_t>((accel_data[0] << 8) | accel_data[1])) *
+              ACCEL_SCALE;
+    accel.y = -static_cast<float>(
+                  static_cast<int16_t>((accel_data[2] << 8) | accel_data[3])) *
+              ACCEL_SCALE;
+    accel.x = static_cast<float>(
+                  static_cast<int16_t>((accel_data[4] << 8) | accel_data[5])) *
+              ACCEL_SCALE;
+
+    gyro.z = static_cast<float>(
+                 static_cast<int16_t>((gyro_data[0] << 8) | gyro_data[1])) *
+                 GYRO_SCALE -
+             gyro_bias_.z;
+    gyro.y = -static_cast<float>(
+                 static_cast<int16_t>((gyro_data[2] << 8) | gyro_data[3])) *
+                 GYRO_SCALE -
+             gyro_bias_.y;
+    gyro.x = static_cast<float>(
+                 static_cast<int16_t>((gyro_data[4] << 8) | gyro_data[5])) *
+                 GYRO_SCALE -
+             gyro_bias_.x;
+  }
+
+  /**
+   * Reads sensor data for acceleration and gyroscope.
+   */
+  void ReadData() {
+    const auto START = std::chrono::steady_clock::now();
+    auto data = spi_device_->ReadRegisters<14>(gpio_cs_, ACCEL_XOUT_H);
+
     uint8_t* accel_data = &data[0];
     uint8_t* temperature_data = &data[6];
     uint8_t* gyro_data = &data[8];
 
-    accel_.z = static_cast<float>(
-                   static_cast<int16_t>((accel_data[0] << 8) | accel_data[1])) *
-               ACCEL_SCALE;
-    accel_.y = -static_cast<float>(
-                   static_cast<int16_t>((accel_data[2] << 8) | accel_data[3])) *
-               ACCEL_SCALE;
-    accel_.x = static_cast<float>(
-                   static_cast<int16_t>((accel_data[4] << 8) | accel_data[5])) *
-               ACCEL_SCALE;
+    Type::Vector3 gyro;
+    DecodeSample(accel_data, gyro_data, accel_, gyro);
 
     temperature_ = static_cast<float>(static_cast<int16_t>(
                        (temperature_data[0] << 8) | temperature_data[1])) /
                        333.87f +
                    21.0f;
 
-    float gyro_z = static_cast<float>(static_cast<int16_t>((gyro_data[0] << 8) |
-                                                           gyro_data[1])) *
-                       GYRO_SCALE -
-                   gyro_bias_.z;
-    float gyro_y = -static_cast<float>(static_cast<int16_t>(
-                       (gyro_data[2] << 8) | gyro_data[3])) *
-                       GYRO_SCALE -
-                   gyro_bias_.y;
-    float gyro_x = static_cast<float>(static_cast<int16_t>((gyro_data[4] << 8) |
-                                                           gyro_data[5])) *
-                       GYRO_SCALE -
-                   gyro_bias_.x;
-
-    gyro_delta_.x = gyro_x - gyro_.x;
-    gyro_delta_.y = gyro_y - gyro_.y;
-    gyro_delta_.z = gyro_z - gyro_.z;
-
-    gyro_.x = gyro_x;
-    gyro_.y = gyro_y;
-    gyro_.z = gyro_z;
+    gyro_ = gyro;
+    FeedCalibration(gyro);
+    Metrics::Default().Latency(Metrics::Stage::IMU_READ).RecordSince(START);
 
     if (data_callback_) {
       data_callback_(accel_, gyro_);
@@ -273,14 +416,16 @@ class Mpu9250 {
 
   /**
    * Save the calibration data to a file.
+   *
+   * @param bias Gyro bias to store
    */
-  void SaveCalibrationData() {
+  void SaveCalibrationData(const Type::Vector3& bias) {
     std::ofstream file("cali_data.bin", std::ios::binary);
     if (!file) {
       std::cerr << "Error: Unable to open cali_data.bin for writing.\n";
       return;
     }
-    file.write(reinterpret_cast<const char*>(&gyro_bias_), sizeof(gyro_bias_));
+    file.write(reinterpret_cast<const char*>(&bias), sizeof(bias));
     file.close();
     std::cout << "Calibration data saved successfully.\n";
   }
@@ -325,6 +470,7 @@ class Mpu9250 {
              "default values.\n";
       gyro_bias_ = {0, 0, 0};
     } else {
+      bias_ready_.store(true, std::memory_order_release);
       std::cout << "MPU9250 calibration data loaded successfully: "
                 << "X=" << gyro_bias_.x << ", "
                 << "Y=" << gyro_bias_.y << ", "
@@ -351,6 +497,38 @@ class Mpu9250 {
   static constexpr uint8_t I2C_MST_CTRL = 0x24;
   static constexpr uint8_t I2C_MST_DELAY_CTRL = 0x67;
   static constexpr uint8_t I2C_SLV0_CTRL = 0x27;
+  static constexpr uint8_t FIFO_EN = 0x23;
+  static constexpr uint8_t FIFO_COUNT_H = 0x72;
+  static constexpr uint8_t FIFO_R_W = 0x74;
+
+  /** USER_CTRL bits */
+  static constexpr uint8_t USER_CTRL_FIFO_EN = 0x40;
+  static constexpr uint8_t USER_CTRL_I2C_MST_EN = 0x20;
+  static constexpr uint8_t USER_CTRL_FIFO_RST = 0x04;
+
+  /** FIFO layout and timing */
+  static constexpr size_t FIFO_SIZE = 512;
+  static constexpr size_t FIFO_SAMPLE_BYTES = 12; /* Accel XYZ + gyro XYZ */
+  static constexpr size_t FIFO_MAX_SAMPLES = FIFO_SIZE / FIFO_SAMPLE_BYTES;
+  static constexpr uint64_t SAMPLE_PERIOD_US = 1000; /* SMPLRT_DIV = 0 */
+  static constexpr std::chrono::milliseconds FIFO_DRAIN_PERIOD{10};
+
+  /** Register access start-up time after reset (typical) and its
+   * worst case, from the datasheet */
+  static constexpr std::chrono::milliseconds RESET_MIN_DELAY{11};
+  static constexpr std::chrono::milliseconds RESET_TIMEOUT{100};
+
+  /** WHO_AM_I of the MPU9250 and its MPU6500/MPU6050 relatives */
+  static constexpr bool IsKnownId(uint8_t id) {
+    return id == 0x71 || id == 0x68 || id == 0x70;
+  }
+
+  /** Gyro calibration (in samples at SAMPLE_PERIOD_US) and thresholds */
+  static constexpr uint32_t CALI_WARMUP_SAMPLES = 5000;   /* 5 s at rest */
+  static constexpr uint32_t CALI_COLLECT_SAMPLES = 25000; /* Then 25 s */
+  static constexpr float CALI_MOTION_XY = 0.005f; /* rad/s between samples */
+  static constexpr float CALI_MOTION_Z = 0.01f;
+  static constexpr float CALI_MIN_BIAS = 0.005f; /* rad/s worth applying */
 
   /** AK8963 Magnetometer registers */
   static constexpr uint8_t AK8963_CNTL1_REG = 0x0A;
@@ -360,18 +538,147 @@ class Mpu9250 {
   SpiDevice* spi_device_; /* SPI device handle */
   Gpio* gpio_cs_;         /* GPIO chip select handle */
   Gpio* gpio_int_;        /* GPIO interrupt handle */
+  Mode mode_;             /* Sample acquisition mode */
 
   Type::Vector3 accel_;      /* Accelerometer data */
   Type::Vector3 gyro_;       /* Gyroscope data */
   Type::Vector3 mag_;        /* Magnetometer data */
-  Type::Vector3 gyro_delta_; /* Gyroscope delta data */
 
   Type::Vector3 gyro_bias_ = {0, 0, 0}; /* Gyroscope calibration data */
+  std::atomic<bool> bias_ready_{false};  /* Bias loaded or measured */
 
   float temperature_ = 0; /* Temperature data */
 
   std::function<void(const Type::Vector3& accel, const Type::Vector3& gyro)>
       data_callback_; /* Data callback function */
+  std::function<void(std::span<const Type::ImuSample>)>
+      batch_callback_; /* FIFO batch callback function */
+
+  std::array<uint8_t, FIFO_SIZE> fifo_raw_{}; /* FIFO burst read buffer */
+  std::array<Type::ImuSample, FIFO_MAX_SAMPLES>
+      fifo_samples_{}; /* Decoded FIFO samples */
+  std::atomic<uint32_t> fifo_overflows_{0}; /* FIFO overflow counter */
+
+  /* FIFO drain job and its single realtime worker */
+  std::unique_ptr<TimerService> fifo_timers_;
+  TimerService::TimerId fifo_timer_ = TimerService::INVALID_TIMER;
+  /* Data-ready poll loop on the realtime core (interrupt mode) */
+  std::unique_ptr<GpioEventLoop> irq_loop_;
+
+  /** Running mean and variance per gyro axis (Welford) */
+  struct GyroStatistics {
+    uint32_t count = 0;
+    std::array<double, 3> mean{};
+    std::array<double, 3> m2{};
+
+    void Add(const Type::Vector3& gyro) {
+      const std::array<double, 3> VALUE = {gyro.x, gyro.y, gyro.z};
+      count++;
+      for (size_t i = 0; i < 3; ++i) {
+        double delta = VALUE[i] - mean[i];
+        mean[i] += delta / count;
+        m2[i] += delta * (VALUE[i] - mean[i]);
+      }
+    }
+
+    Type::Vector3 Mean() const {
+      return {static_cast<float>(mean[0]), static_cast<float>(mean[1]),
+              static_cast<float>(mean[2])};
+    }
+
+    Type::Vector3 StdDev() const {
+      auto axis = [this](size_t i) {
+        return count > 1 ? static_cast<float>(std::sqrt(m2[i] / (count - 1)))
+                         : 0.0f;
+      };
+      return {axis(0), axis(1), axis(2)};
+    }
+  };
+
+  /**
+   * Calibration step for one decoded sample (sample thread only).
+   *
+   * Costs one relaxed atomic load per sample when no session is running.
+   */
+  void FeedCalibration(const Type::Vector3& gyro) {
+    if (cali_requested_.load(std::memory_order_relaxed) &&
+        cali_requested_.exchange(false, std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(cali_mutex_);
+      cali_active_ = true;
+      cali_restart_ = cali_restart_on_motion_;
+      cali_rest_ = 0;
+      cali_stats_ = {};
+    }
+    if (!cali_active_) {
+      return;
+    }
+
+    bool moving = cali_rest_ > 0 &&
+                  (std::fabs(gyro.x - cali_last_gyro_.x) > CALI_MOTION_XY ||
+                   std::fabs(gyro.y - cali_last_gyro_.y) > CALI_MOTION_XY ||
+                   std::fabs(gyro.z - cali_last_gyro_.z) > CALI_MOTION_Z);
+    cali_last_gyro_ = gyro;
+    if (moving) {
+      if (!cali_restart_) {
+        FinishCalibration(CalibrationResult::Status::ABORTED);
+        return;
+      }
+      cali_rest_ = 0;
+      cali_stats_ = {};
+    }
+
+    if (++cali_rest_ <= CALI_WARMUP_SAMPLES) {
+      return;
+    }
+    cali_stats_.Add(gyro);
+    if (cali_stats_.count < CALI_COLLECT_SAMPLES) {
+      return;
+    }
+
+    Type::Vector3 bias = cali_stats_.Mean();
+    if (std::fabs(bias.x) > CALI_MIN_BIAS || std::fabs(bias.y) > CALI_MIN_BIAS ||
+        std::fabs(bias.z) > CALI_MIN_BIAS) {
+      gyro_bias_.x += bias.x;
+      gyro_bias_.y += bias.y;
+      gyro_bias_.z += bias.z;
+
+      /* File I/O stays off the sample thread */
+      save_timer_ = TimerService::Default().AddOneShot(
+          std::chrono::nanoseconds::zero(),
+          [this, saved = gyro_bias_]() { SaveCalibrationData(saved); });
+      FinishCalibration(CalibrationResult::Status::APPLIED);
+    } else {
+      std::cout << "No need to calibrate\n";
+      FinishCalibration(CalibrationResult::Status::UNCHANGED);
+    }
+  }
+
+  void FinishCalibration(CalibrationResult::Status status) {
+    cali_active_ = false;
+    if (status != CalibrationResult::Status::ABORTED) {
+      bias_ready_.store(true, std::memory_order_release);
+    }
+    std::lock_guard<std::mutex> lock(cali_mutex_);
+    cali_promise_.set_value(CalibrationResult{status, gyro_bias_,
+                                              cali_stats_.StdDev(),
+                                              cali_stats_.count});
+    cali_pending_ = false;
+    std::cout << "Calibration completed\n";
+  }
 
-  std::thread calibrate_thread_; /* Thread */
+  /* Sample thread calibration state */
+  bool cali_active_ = false;        /* Session running */
+  bool cali_restart_ = false;       /* Motion restarts instead of aborting */
+  uint32_t cali_rest_ = 0;          /* Consecutive samples at rest */
+  Type::Vector3 cali_last_gyro_{};  /* Previous sample for motion check */
+  GyroStatistics cali_stats_;       /* Accumulator after the warmup */
+
+  /* Session handoff between RequestCalibration() and the sample thread */
+  std::atomic<bool> cali_requested_{false};
+  std::mutex cali_mutex_;
+  bool cali_pending_ = false;            /* Promise not yet fulfilled */
+  bool cali_restart_on_motion_ = false; /* Mode of the requested session */
+  std::promise<CalibrationResult> cali_promise_;
+  std::shared_future<CalibrationResult> cali_future_;
+  std::atomic<TimerService::TimerId> save_timer_{TimerService::INVALID_TIMER};
 };
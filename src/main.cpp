@@ -1,6 +1,11 @@
+#include <chrono>
+#include <cstdlib>
 #include <format>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <thread>
+#include <utility>
 
 #include "ads1115.hpp"
 #include "aht20.hpp"
@@ -9,62 +14,135 @@
 #include "bsp_i2c.hpp"
 #include "bsp_pwm.hpp"
 #include "bsp_spi.hpp"
+#include "bsp_thread.hpp"
 #include "comp_ahrs.hpp"
 #include "comp_gui.hpp"
 #include "comp_inference.hpp"
+#include "comp_metrics.hpp"
+#include "comp_timer.hpp"
 #include "fluxsand.hpp"
 #include "max7219.hpp"
 #include "mpu9250.hpp"
 
 int main() {
-  /* Buzzer */
-  PWM pwm_buzzer(0, 50, 7.5);
+  /* Before any thread starts, so they all inherit the general cores */
+  ThreadConfig::ReserveRealtimeCore();
 
-  pwm_buzzer.PlayNote(PWM::NoteName::C, 7, 250);
-  std::this_thread::sleep_for(std::chrono::milliseconds(300));
-  pwm_buzzer.PlayNote(PWM::NoteName::D, 7, 250);
-  std::this_thread::sleep_for(std::chrono::milliseconds(300));
-  pwm_buzzer.PlayNote(PWM::NoteName::E, 7, 250);
-  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  const auto BOOT_START = std::chrono::steady_clock::now();
 
-  pwm_buzzer.Disable();
+  /* Buzzer, the boot chime plays while the devices come up */
+  PWM pwm_buzzer(0, 50, 7.5);
+  auto chime_done = std::async(std::launch::async, [&pwm_buzzer]() {
+    for (auto note : {PWM::NoteName::C, PWM::NoteName::D, PWM::NoteName::E}) {
+      pwm_buzzer.PlayNote(note, 7, 250);
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+    pwm_buzzer.Disable();
+  });
 
   /* User button */
   Gpio gpio_user_button_1("gpiochip0", 23, false, 1);
   Gpio gpio_user_button_2("gpiochip0", 24, false, 1);
 
-  /* Max7219 display */
-  SpiDevice spi_display("/dev/spidev1.0", 1000000, SPI_MODE_0);
-  Gpio gpio_display_cs("gpiochip0", 26, true, 1);
-  Max7219<8> display(spi_display, &gpio_display_cs);
-
-  /* BMP280 and AHT20 */
-  I2cDevice i2c_bmp280("/dev/i2c-1", Bmp280::DEFAULT_I2C_ADDR);
-  Bmp280 bmp280(i2c_bmp280);
+  /* Buses and pins are cheap to open; the devices behind them are brought
+   * up in parallel, one thread per bus plus one for the ONNX session. */
 
-  I2cDevice i2c_aht20("/dev/i2c-1", Aht20::DEFAULT_I2C_ADDR);
-  Aht20 aht20(i2c_aht20);
+  /* Max7219 display, CS on GPIO26.
+   * FLUXSAND_KERNEL_CS=1 leaves CS to the kernel so a frame is a single
+   * ioctl; needs dtoverlay=spi1-1cs,cs0_pin=26 in config.txt.
+   * FLUXSAND_SELF_TEST=1 draws the diagnostic pattern first. */
+  SpiDevice spi_display("/dev/spidev1.0", 1000000, SPI_MODE_0);
+  std::unique_ptr<Gpio> gpio_display_cs;
+  if (std::getenv("FLUXSAND_KERNEL_CS") == nullptr) {
+    gpio_display_cs = std::make_unique<Gpio>("gpiochip0", 26, true, 1);
+  }
+  const bool SELF_TEST = std::getenv("FLUXSAND_SELF_TEST") != nullptr;
+  auto display_ready = std::async(std::launch::async, [&]() {
+    return std::make_unique<Max7219<8>>(spi_display, gpio_display_cs.get(),
+                                        SELF_TEST);
+  });
+
+  /* BMP280 and AHT20 share I2C bus 1 */
+  I2cBus i2c_bus_1("/dev/i2c-1");
+  I2cDevice i2c_bmp280(i2c_bus_1, Bmp280::DEFAULT_I2C_ADDR);
+  I2cDevice i2c_aht20(i2c_bus_1, Aht20::DEFAULT_I2C_ADDR);
+  auto environment_ready = std::async(std::launch::async, [&]() {
+    return std::make_pair(std::make_unique<Bmp280>(i2c_bmp280),
+                          std::make_unique<Aht20>(i2c_aht20));
+  });
 
   /* ADS1115 */
-  I2cDevice i2c_mpu9250("/dev/i2c-0", Ads1115<2>::DEFAULT_I2C_ADDR);
+  I2cBus i2c_bus_0("/dev/i2c-0");
+  I2cDevice i2c_ads1115(i2c_bus_0, Ads1115<2>::DEFAULT_I2C_ADDR);
   Gpio gpio_ads1115_int("gpiochip0", 5, false, 1);
-  Ads1115<2> ads1115(i2c_mpu9250, gpio_ads1115_int);
+  auto adc_ready = std::async(std::launch::async, [&]() {
+    return std::make_unique<Ads1115<2>>(i2c_ads1115, gpio_ads1115_int);
+  });
 
   /* MPU9250 */
   SpiDevice spi_imu_device("/dev/spidev0.0", 1000000, SPI_MODE_0);
   Gpio gpio_imu_cs("gpiochip0", 22, true, 1);
   Gpio gpio_imu_int("gpiochip0", 27, false, 1);
-  Mpu9250 mpu9250(&spi_imu_device, &gpio_imu_cs, &gpio_imu_int);
+  auto imu_ready = std::async(std::launch::async, [&]() {
+    return std::make_unique<Mpu9250>(&spi_imu_device, &gpio_imu_cs,
+                                     &gpio_imu_int, Mpu9250::Mode::FIFO);
+  });
+
+  /* CNN model inference.
+   * FLUXSAND_MODEL_VARIANT=int8 selects the quantized model if installed */
+  InferenceConfig inference_config;
+  if (const char* variant = std::getenv("FLUXSAND_MODEL_VARIANT")) {
+    inference_config.variant = variant;
+  }
+  auto inference_ready = std::async(std::launch::async, [&]() {
+    return std::make_unique<InferenceEngine>(ONNX_MODEL_PATH, 0.1f, 0.65f, 6,
+                                             3, inference_config);
+  });
 
-  /* Orientation prediction and CNN model inference */
+  /* Orientation prediction, fed as soon as the IMU is up */
   AHRS ahrs;
-  mpu9250.RegisterDataCallback(std::bind(
-      &AHRS::OnData, &ahrs, std::placeholders::_1, std::placeholders::_2));
-
-  InferenceEngine inference_engine(ONNX_MODEL_PATH, 0.1f, 0.65f, 6, 3);
-  ahrs.RegisterDataCallback(std::bind(
-      &InferenceEngine::OnData, &inference_engine, std::placeholders::_1,
-      std::placeholders::_2, std::placeholders::_3));
+  auto imu = imu_ready.get();
+  Mpu9250& mpu9250 = *imu;
+  mpu9250.RegisterBatchCallback(
+      std::bind(&AHRS::OnSamples, &ahrs, std::placeholders::_1));
+
+  auto inference = inference_ready.get();
+  InferenceEngine& inference_engine = *inference;
+  ahrs.RegisterDataCallback(std::bind(&InferenceEngine::OnData,
+                                      &inference_engine, std::placeholders::_1,
+                                      std::placeholders::_2));
+
+  auto display_device = display_ready.get();
+  Max7219<8>& display = *display_device;
+  auto [bmp280, aht20] = environment_ready.get();
+  auto ads1115 = adc_ready.get();
+  chime_done.get();
+
+  std::cout << std::format(
+      "Devices up after {} ms\n",
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - BOOT_START)
+          .count());
+
+  /* Drop counters next to the stage latencies, exported to the
+   * service's RuntimeDirectory for field diagnostics */
+  Metrics& metrics = Metrics::Default();
+  metrics.AddCounter("imu_fifo_overflows_total",
+                     [&]() { return mpu9250.GetFifoOverflowCount(); });
+  metrics.AddCounter("ahrs_dropped_samples_total",
+                     [&]() { return ahrs.GetDroppedSamples(); });
+  metrics.AddCounter("inference_dropped_samples_total", [&]() {
+    return inference_engine.GetDroppedSamples();
+  });
+  metrics.AddCounter("inference_gated_runs_total",
+                     [&]() { return inference_engine.GetSkippedRuns(); });
+  metrics.AddCounter("display_frames_skipped_total", [&]() {
+    return display.GetRefreshStats().frames_skipped;
+  });
+  metrics.AddCounter("timer_missed_deadlines_total", []() {
+    return TimerService::Default().GetTotalStats().missed;
+  });
+  metrics.StartExport();
 
   CompGuiX gui(display);
 
@@ -72,7 +150,8 @@ int main() {
 
   /* Main loop */
   FluxSand fluxsand(&pwm_buzzer, &gpio_user_button_1, &gpio_user_button_2, &gui,
-                    &bmp280, &aht20, &ads1115, &ahrs, &inference_engine);
+                    bmp280.get(), aht20.get(), ads1115.get(), &ahrs,
+                    &inference_engine, &mpu9250);
 
   while (true) {
     fluxsand.Run();
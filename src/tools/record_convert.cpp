@@ -0,0 +1,114 @@
+/*
+ * Convert a DataRecorder recording (.bin) to CSV.
+ *
+ * Usage: FluxSandRecordConvert <in.bin> [out.csv] [--model]
+ *
+ * Without an output path the CSV is written to stdout. The default layout
+ * has every record field; --model writes the eight columns the gesture
+ * model is trained on, matching the old InferenceEngine CSV recordings.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "comp_recorder.hpp"
+
+static void PrintUsage(const char* name) {
+  std::fprintf(stderr, "Usage: %s <in.bin> [out.csv] [--model]\n", name);
+}
+
+int main(int argc, char* argv[]) {
+  const char* in_path = nullptr;
+  const char* out_path = nullptr;
+  bool model_layout = false;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--model") == 0) {
+      model_layout = true;
+    } else if (!in_path) {
+      in_path = argv[i];
+    } else if (!out_path) {
+      out_path = argv[i];
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (!in_path) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::FILE* in = std::fopen(in_path, "rb");
+  if (!in) {
+    std::perror(in_path);
+    return 1;
+  }
+
+  DataRecordHeader header{};
+  if (std::fread(&header, sizeof(header), 1, in) != 1 ||
+      header.magic != DataRecordHeader::MAGIC) {
+    std::fprintf(stderr, "%s: not a FluxSand recording\n", in_path);
+    std::fclose(in);
+    return 1;
+  }
+  if (header.version != DataRecordHeader::VERSION ||
+      header.record_size != sizeof(DataRecord)) {
+    std::fprintf(stderr, "%s: unsupported version %u (record size %u)\n",
+                 in_path, header.version, header.record_size);
+    std::fclose(in);
+    return 1;
+  }
+
+  std::FILE* out = out_path ? std::fopen(out_path, "w") : stdout;
+  if (!out) {
+    std::perror(out_path);
+    std::fclose(in);
+    return 1;
+  }
+
+  if (model_layout) {
+    std::fputs("Pitch,Roll,Gyro_X,Gyro_Y,Gyro_Z,Accel_X,Accel_Y,Accel_Z\n",
+               out);
+  } else {
+    std::fputs(
+        "timestamp_us,accel_x,accel_y,accel_z,gyro_x,gyro_y,gyro_z,"
+        "q0,q1,q2,q3,roll,pitch,yaw,label\n",
+        out);
+  }
+
+  /* Timestamps are relative to the first record */
+  DataRecord records[256];
+  uint64_t first_us = 0;
+  size_t total = 0;
+  size_t n;
+  while ((n = std::fread(records, sizeof(DataRecord), std::size(records),
+                         in)) > 0) {
+    for (size_t i = 0; i < n; ++i) {
+      const DataRecord& r = records[i];
+      if (total++ == 0) {
+        first_us = r.timestamp_us;
+      }
+      if (model_layout) {
+        std::fprintf(out, "%g,%g,%g,%g,%g,%g,%g,%g\n", r.eulr[1], r.eulr[0],
+                     r.gyro[0], r.gyro[1], r.gyro[2], r.accel[0], r.accel[1],
+                     r.accel[2]);
+      } else {
+        std::fprintf(out,
+                     "%llu,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%d\n",
+                     static_cast<unsigned long long>(r.timestamp_us -
+                                                     first_us),
+                     r.accel[0], r.accel[1], r.accel[2], r.gyro[0], r.gyro[1],
+                     r.gyro[2], r.quat[0], r.quat[1], r.quat[2], r.quat[3],
+                     r.eulr[0], r.eulr[1], r.eulr[2], r.label);
+      }
+    }
+  }
+
+  std::fclose(in);
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  std::fprintf(stderr, "Converted %zu records\n", total);
+  return 0;
+}
@@ -0,0 +1,322 @@
+/*
+ * Hardware-free benchmark of the sample-to-pixel hot paths.
+ *
+ * Usage: FluxSandBench [recording.bin ...] [--model <path.onnx>]
+ *                      [--repeat <n>] [--out <report.json>]
+ *
+ * Replays DataRecorder recordings, or a synthetic trace when none are
+ * given, in the 10-sample batches Mpu9250 delivers from its FIFO. The
+ * samples run through AHRS, InferenceEngine, the sand engines and CompGuiX
+ * drawing into a MAX7219 chain on the stub SPI device, so nothing touches
+ * hardware. Sample timestamps come from a virtual 1 kHz clock, sand
+ * frames are taken every 25 and display refreshes every 5 virtual
+ * milliseconds. The display and GUI timer jobs are stopped, so no stage
+ * sleeps or runs on the wall clock and every run does the same work.
+ * Latency percentiles and throughput of every component are written as
+ * JSON, to stdout unless --out is given.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bsp.hpp"
+#include "bsp_spi.hpp"
+#include "comp_ahrs.hpp"
+#include "comp_gui.hpp"
+#include "comp_inference.hpp"
+#include "comp_recorder.hpp"
+#include "comp_sand.hpp"
+#include "comp_type.hpp"
+#include "max7219.hpp"
+
+namespace {
+
+/* Pipeline cadence, matching the device */
+constexpr uint64_t SAMPLE_PERIOD_US = 1000; /* MPU9250 at 1 kHz */
+constexpr size_t FIFO_BATCH = 10;           /* One 10 ms FIFO drain */
+constexpr uint64_t FRAME_PERIOD_US = 25000; /* CompGuiX sand period */
+constexpr uint64_t REFRESH_PERIOD_US =
+    std::chrono::microseconds(Max7219<8>::REFRESH_PERIOD).count();
+constexpr int FILL_GRAINS = 128;
+constexpr size_t SYNTHETIC_SAMPLES = 20000;
+
+/* Per-call latencies of one component */
+struct Series {
+  std::vector<double> latency_us;
+  uint64_t items = 0; /* Samples, frames or runs processed */
+
+  template <typename Function>
+  void Time(uint64_t count, Function&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    latency_us.push_back(
+        std::chrono::duration<double, std::micro>(elapsed).count());
+    items += count;
+  }
+};
+
+double Quantile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  size_t index = static_cast<size_t>(q * static_cast<double>(sorted.size()));
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+std::string ComponentJson(const char* name, uint64_t calls, uint64_t items,
+                          double total_us, double p50_us, double p99_us,
+                          double p999_us, double max_us) {
+  double throughput =
+      total_us > 0.0 ? static_cast<double>(items) * 1e6 / total_us : 0.0;
+  return std::format(
+      "    \"{}\": {{\"calls\": {}, \"items\": {}, \"total_ms\": {:.3f}, "
+      "\"throughput_per_s\": {:.1f}, \"p50_us\": {:.3f}, \"p99_us\": {:.3f}, "
+      "\"p999_us\": {:.3f}, \"max_us\": {:.3f}}}",
+      name, calls, items, total_us / 1000.0, throughput, p50_us, p99_us,
+      p999_us, max_us);
+}
+
+std::string ToJson(const char* name, Series& series) {
+  std::vector<double>& sorted = series.latency_us;
+  std::sort(sorted.begin(), sorted.end());
+  double total_us = 0.0;
+  for (double us : sorted) {
+    total_us += us;
+  }
+  return ComponentJson(name, sorted.size(), series.items, total_us,
+                       Quantile(sorted, 0.5), Quantile(sorted, 0.99),
+                       Quantile(sorted, 0.999),
+                       sorted.empty() ? 0.0 : sorted.back());
+}
+
+/* Loads the IMU channels of a DataRecorder recording */
+bool LoadRecording(const char* path, std::vector<Type::ImuSample>& trace) {
+  std::FILE* file = std::fopen(path, "rb");
+  if (!file) {
+    std::perror(path);
+    return false;
+  }
+
+  DataRecordHeader header{};
+  if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+      header.magic != DataRecordHeader::MAGIC ||
+      header.version != DataRecordHeader::VERSION ||
+      header.record_size != sizeof(DataRecord)) {
+    std::fprintf(stderr, "%s: not a supported FluxSand recording\n", path);
+    std::fclose(file);
+    return false;
+  }
+
+  DataRecord record;
+  while (std::fread(&record, sizeof(record), 1, file) == 1) {
+    trace.push_back(Type::ImuSample{
+        {record.accel[0], record.accel[1], record.accel[2]},
+        {record.gyro[0], record.gyro[1], record.gyro[2]},
+        0});
+  }
+  std::fclose(file);
+  return true;
+}
+
+/* Slow tilts with a few shakes, deterministic across runs */
+void SynthesizeTrace(std::vector<Type::ImuSample>& trace) {
+  std::mt19937 rng(1234);
+  std::normal_distribution<float> noise(0.0f, 0.02f);
+  for (size_t i = 0; i < SYNTHETIC_SAMPLES; ++i) {
+    float t = static_cast<float>(i) * 1e-3f;
+    float roll = 0.8f * std::sin(2.0f * M_PI * 0.25f * t);
+    float roll_rate = 0.4f * M_PI * std::cos(2.0f * M_PI * 0.25f * t);
+    bool shaking = (i / 2000) % 4 == 3;
+    float shake = shaking ? 6.0f * std::sin(2.0f * M_PI * 8.0f * t) : 0.0f;
+    trace.push_back(Type::ImuSample{
+        {noise(rng) + shake, M_1G * std::sin(roll) + noise(rng),
+         M_1G * std::cos(roll) + noise(rng)},
+        {roll_rate + noise(rng), noise(rng), noise(rng)},
+        0});
+  }
+}
+
+void PrintUsage(const char* name) {
+  std::fprintf(stderr,
+               "Usage: %s [recording.bin ...] [--model <path.onnx>] "
+               "[--repeat <n>] [--out <report.json>]\n",
+               name);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string model_path = ONNX_MODEL_PATH;
+  const char* out_path = nullptr;
+  int repeat = 1;
+  std::vector<Type::ImuSample> trace;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+      model_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (argv[i][0] == '-') {
+      PrintUsage(argv[0]);
+      return 1;
+    } else if (!LoadRecording(argv[i], trace)) {
+      return 1;
+    }
+  }
+  const bool SYNTHETIC = trace.empty();
+  if (SYNTHETIC) {
+    SynthesizeTrace(trace);
+  }
+
+  /* Null display sink: the stub SPI device discards every transfer */
+  SpiDevice spi_display("/dev/null", 1000000, SPI_MODE_0);
+  Max7219<8> display(spi_display, nullptr, false);
+  CompGuiX gui(display);
+
+  /* Refresh and sand steps follow the virtual clock below instead */
+  display.StopRefreshTimer();
+  gui.StopSandTimer();
+
+  AHRS ahrs;
+  std::vector<Type::AttitudeSample> attitude;
+  attitude.reserve(FIFO_BATCH);
+  ahrs.RegisterDataCallback(
+      [&](const Type::ImuSample& sample, const Type::Eulr& eulr) {
+        attitude.push_back(Type::AttitudeSample{sample, eulr});
+      });
+
+  InferenceConfig config;
+  config.start_thread = false;
+  InferenceEngine inference(model_path, 0.1f, 0.65f, 6, 3, config);
+
+  SandEngine sand_up, sand_down;
+  SandGrid grid_up, grid_down;
+  for (int i = 0; i < FILL_GRAINS; ++i) {
+    sand_up.AddNewSand();
+    sand_up.StepOnce(0);
+    grid_up.AddNewSand();
+    grid_up.StepOnce(0);
+  }
+
+  Series ahrs_series, inference_series, sand_series, grid_series, gui_series,
+      refresh_series;
+  uint64_t steps = 0;
+  uint64_t gestures = 0;
+  uint64_t virtual_us = 0;
+  uint64_t next_frame_us = FRAME_PERIOD_US;
+  uint64_t next_refresh_us = REFRESH_PERIOD_US;
+  std::array<Type::ImuSample, FIFO_BATCH> batch;
+
+  auto wall_start = std::chrono::steady_clock::now();
+
+  for (int pass = 0; pass < repeat; ++pass) {
+    for (size_t first = 0; first < trace.size(); first += FIFO_BATCH) {
+      const size_t COUNT = std::min(FIFO_BATCH, trace.size() - first);
+      for (size_t i = 0; i < COUNT; ++i) {
+        batch[i] = trace[first + i];
+        batch[i].timestamp_us = (virtual_us += SAMPLE_PERIOD_US);
+      }
+
+      attitude.clear();
+      ahrs_series.Time(COUNT, [&]() {
+        ahrs.Update(std::span<const Type::ImuSample>(batch.data(), COUNT));
+      });
+
+      for (const auto& sample : attitude) {
+        const uint64_t EXECUTED = inference.GetExecutedRuns();
+        InferenceResult result;
+        auto start = std::chrono::steady_clock::now();
+        bool stepped = inference.ProcessSample(sample, result);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (inference.GetExecutedRuns() != EXECUTED) {
+          inference_series.latency_us.push_back(
+              std::chrono::duration<double, std::micro>(elapsed).count());
+          inference_series.items++;
+        }
+        steps += stepped;
+        gestures += stepped && result.gesture != ModelOutput::UNRECOGNIZED;
+      }
+
+      /* Display refreshes and sand frames follow the virtual clock; a
+       * refresh sends whatever the last frame drew */
+      for (; next_refresh_us <= virtual_us;
+           next_refresh_us += REFRESH_PERIOD_US) {
+        refresh_series.Time(1, [&]() { display.Refresh(); });
+      }
+      if (virtual_us < next_frame_us) {
+        continue;
+      }
+      next_frame_us += FRAME_PERIOD_US;
+      const float ROLL = ahrs.GetRoll();
+      const float DEG = std::fmod(630.0f - ROLL * 180.0f / M_PI, 360.0f);
+
+      sand_series.Time(1, [&]() {
+        SandEngine::MoveSand(&sand_up, &sand_down, DEG);
+        sand_up.StepOnce(DEG);
+        sand_down.StepOnce(DEG);
+      });
+      grid_series.Time(1, [&]() {
+        SandGrid::MoveSand(&grid_up, &grid_down, DEG);
+        grid_up.StepOnce(DEG);
+        grid_down.StepOnce(DEG);
+      });
+      gui_series.Time(1, [&]() { gui.RenderHourglass(&sand_up, &sand_down); });
+
+      /* Turn the hourglass over once it has run out, keeping sand moving */
+      if (sand_up.Count() == 0) {
+        std::swap(sand_up, sand_down);
+      }
+      if (grid_up.Count() == 0) {
+        std::swap(grid_up, grid_down);
+      }
+    }
+  }
+
+  const double WALL_S = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - wall_start)
+                            .count();
+
+  std::string json = "{\n";
+  json += std::format(
+      "  \"trace\": \"{}\",\n  \"model\": \"{}\",\n  \"samples\": {},\n"
+      "  \"virtual_s\": {:.3f},\n  \"wall_s\": {:.3f},\n"
+      "  \"classification_steps\": {},\n  \"gated_runs\": {},\n"
+      "  \"gestures\": {},\n",
+      SYNTHETIC ? "synthetic" : "recordings", model_path,
+      trace.size() * static_cast<size_t>(repeat),
+      static_cast<double>(virtual_us) / 1e6, WALL_S, steps,
+      inference.GetSkippedRuns(), gestures);
+  json += "  \"components\": {\n";
+  json += ToJson("ahrs", ahrs_series) + ",\n";
+  json += ToJson("inference", inference_series) + ",\n";
+  json += ToJson("sand_engine", sand_series) + ",\n";
+  json += ToJson("sand_grid", grid_series) + ",\n";
+  json += ToJson("gui_render", gui_series) + ",\n";
+  json += ToJson("spi_refresh", refresh_series) + "\n";
+  json += "  }\n}\n";
+
+  std::FILE* out = out_path ? std::fopen(out_path, "w") : stdout;
+  if (!out) {
+    std::perror(out_path);
+    return 1;
+  }
+  std::fputs(json.c_str(), out);
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
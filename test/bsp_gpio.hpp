@@ -5,6 +5,26 @@
 #include <thread>
 #include <chrono>
 
+#include "bsp_thread.hpp"
+
+/* Edges are simulated per line below, the loop only carries the role */
+class GpioEventLoop {
+ public:
+  explicit GpioEventLoop(
+      ThreadConfig::Role role = ThreadConfig::Role::GPIO_EVENTS)
+      : role_(role) {}
+
+  static GpioEventLoop& Default() {
+    static GpioEventLoop loop;
+    return loop;
+  }
+
+  ThreadConfig::Role Role() const { return role_; }
+
+ private:
+  ThreadConfig::Role role_;
+};
+
 class Gpio {
  public:
   using Callback = std::function<void()>;
@@ -21,10 +41,12 @@ class Gpio {
     return value_;
   }
 
-  void EnableInterruptRisingEdgeWithCallback(Callback cb) {
+  void EnableInterruptRisingEdgeWithCallback(
+      Callback cb, GpioEventLoop& loop = GpioEventLoop::Default()) {
     callback_ = std::move(cb);
     interrupt_enabled_ = true;
-    interrupt_thread_ = std::thread([this]() {
+    interrupt_thread_ = std::thread([this, role = loop.Role()]() {
+      ThreadConfig::Apply(role);
       int last = value_;
       while (interrupt_enabled_) {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -36,11 +58,13 @@ class Gpio {
     });
   }
 
-  ~Gpio() {
+  void DisableInterrupt() {
     interrupt_enabled_ = false;
     if (interrupt_thread_.joinable()) interrupt_thread_.join();
   }
 
+  ~Gpio() { DisableInterrupt(); }
+
  private:
   bool is_output_;
   int value_;
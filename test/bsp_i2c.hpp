@@ -1,12 +1,19 @@
-
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <map>
-#include <vector>
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+class I2cBus {
+ public:
+  explicit I2cBus(const std::string& device) {}
+};
 
 class I2cDevice {
  public:
-  I2cDevice(const std::string& device, uint8_t addr) : addr_(addr) {}
+  I2cDevice(I2cBus& bus, uint8_t addr) : addr_(addr) {}
 
   uint8_t ReadRegister(uint8_t reg) {
     return registers_[reg];
@@ -28,6 +35,10 @@ class I2cDevice {
     }
   }
 
+  void ReadRaw(uint8_t* buffer, size_t length) {
+    ReadRegisters(0x00, buffer, length);
+  }
+
  private:
   uint8_t addr_;
   std::map<uint8_t, uint8_t> registers_;
@@ -1,6 +1,10 @@
 
 #pragma once
+#include <linux/spi/spidev.h>
+
+#include <array>
 #include <map>
+#include <span>
 #include <vector>
 #include <cstdint>
 
@@ -24,6 +28,21 @@ class SpiDevice {
     }
   }
 
+  void ReadRegisters(Gpio* cs, uint8_t reg, std::span<uint8_t> buffer) {
+    ReadRegisters(cs, reg, buffer.data(), buffer.size());
+  }
+
+  template <size_t N>
+  std::array<uint8_t, N> ReadRegisters(Gpio* cs, uint8_t reg) {
+    std::array<uint8_t, N> data{};
+    ReadRegisters(cs, reg, data.data(), N);
+    return data;
+  }
+
+  bool TransferBatch(spi_ioc_transfer* transfers, size_t count) {
+    return true;
+  }
+
   int Fd() const { return 0; }
 
   uint32_t Speed() const { return 1000000; }
@@ -0,0 +1,46 @@
+#pragma once
+#include <pthread.h>
+
+#include <array>
+#include <cstdint>
+
+class ThreadConfig {
+ public:
+  enum class Role : uint8_t {
+    MAIN,
+    GPIO_EVENTS,
+    IMU,
+    AHRS,
+    INFERENCE,
+    RECORDER,
+    BUZZER,
+    NUMBER
+  };
+
+  struct Spec {
+    const char* name;
+    int rt_priority;
+    bool realtime_core;
+  };
+
+  static constexpr std::array<Spec, static_cast<size_t>(Role::NUMBER)> SPECS =
+      {{
+          {"fluxsand", 0, false},
+          {"gpio-events", 0, false},
+          {"imu", 80, true},
+          {"ahrs", 70, true},
+          {"inference", 0, false},
+          {"recorder", 0, false},
+          {"buzzer", 0, false},
+      }};
+
+  static void ReserveRealtimeCore() {}
+
+  /* Names only; the test build leaves affinity and scheduling alone */
+  static bool Apply(Role role) {
+    return pthread_setname_np(pthread_self(),
+                              SPECS[static_cast<size_t>(role)].name) == 0;
+  }
+
+  static int GeneralCoreCount() { return 2; }
+};
@@ -1,3 +1,5 @@
+#include <cstdlib>
+#include <filesystem>
 #include <format>
 #include <iostream>
 #include <thread>
@@ -9,14 +11,35 @@
 #include "bsp_i2c.hpp"
 #include "bsp_pwm.hpp"
 #include "bsp_spi.hpp"
+#include "bsp_thread.hpp"
 #include "comp_ahrs.hpp"
+#include "comp_filter.hpp"
 #include "comp_gui.hpp"
 #include "comp_inference.hpp"
+#include "comp_metrics.hpp"
+#include "comp_recorder.hpp"
+#include "comp_timer.hpp"
 #include "fluxsand.hpp"
 #include "max7219.hpp"
 #include "mpu9250.hpp"
 
 int main() {
+  ThreadConfig::ReserveRealtimeCore();
+
+  /* Shared timer service */
+  TimerService timer_service(1, "timer-test");
+  timer_service.RunUnitTest();
+
+  /* Pipeline instrumentation */
+  Metrics metrics;
+  metrics.RunUnitTest();
+
+  /* Sensor smoothing, same shapes as SensorManager */
+  MovingAverage<float, 50> light_filter;
+  light_filter.RunUnitTest();
+  HysteresisLevel brightness{20.0f, 0.25f, 0, 14};
+  brightness.RunUnitTest();
+
   /* Buzzer */
   PWM pwm_buzzer(0, 50, 7.5);
 
@@ -33,20 +56,22 @@ int main() {
   Gpio gpio_user_button_1("gpiochip0", 23, false, 1);
   Gpio gpio_user_button_2("gpiochip0", 24, false, 1);
 
-  /* Max7219 display */
+  /* Max7219 display, CS on GPIO26 */
   SpiDevice spi_display("/dev/spidev1.0", 1000000, SPI_MODE_0);
   Gpio gpio_display_cs("gpiochip0", 26, true, 1);
   Max7219<8> display(spi_display, &gpio_display_cs);
 
-  /* BMP280 and AHT20 */
-  I2cDevice i2c_bmp280("/dev/i2c-1", Bmp280::DEFAULT_I2C_ADDR);
+  /* BMP280 and AHT20 share I2C bus 1 */
+  I2cBus i2c_bus_1("/dev/i2c-1");
+  I2cDevice i2c_bmp280(i2c_bus_1, Bmp280::DEFAULT_I2C_ADDR);
   Bmp280 bmp280(i2c_bmp280);
 
-  I2cDevice i2c_aht20("/dev/i2c-1", Aht20::DEFAULT_I2C_ADDR);
+  I2cDevice i2c_aht20(i2c_bus_1, Aht20::DEFAULT_I2C_ADDR);
   Aht20 aht20(i2c_aht20);
 
   /* ADS1115 */
-  I2cDevice i2c_mpu9250("/dev/i2c-0", Ads1115<2>::DEFAULT_I2C_ADDR);
+  I2cBus i2c_bus_0("/dev/i2c-0");
+  I2cDevice i2c_mpu9250(i2c_bus_0, Ads1115<2>::DEFAULT_I2C_ADDR);
   Gpio gpio_ads1115_int("gpiochip0", 5, false, 1);
   Ads1115<2> ads1115(i2c_mpu9250, gpio_ads1115_int);
 
@@ -60,8 +85,37 @@ int main() {
   AHRS ahrs;
   ahrs.RunUnitTest();
 
+  DataRecorder recorder;
+  recorder.RunUnitTest();
+
+  /* The timing test owns its engine; the running one has its own thread */
+  {
+    InferenceConfig test_config;
+    test_config.start_thread = false;
+    InferenceEngine test_engine(ONNX_MODEL_PATH, 0.1f, 0.65f, 6, 3,
+                                test_config);
+    test_engine.RunUnitTest();
+  }
   InferenceEngine inference_engine(ONNX_MODEL_PATH, 0.1f, 0.65f, 6, 3);
-  inference_engine.RunUnitTest();
+
+  /* Replay recorded gesture CSVs through every model variant */
+  if (const char* dir = std::getenv("FLUXSAND_BENCH_DIR")) {
+    std::vector<std::string> recordings;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+      if (entry.path().extension() == ".csv") {
+        recordings.push_back(entry.path().string());
+      }
+    }
+    for (const auto& model : InferenceEngine::FindVariants(ONNX_MODEL_PATH)) {
+      InferenceConfig config;
+      config.start_thread = false;
+      config.prefer_ort_model = false;
+      config.prefer_streaming_model = false;
+      InferenceEngine variant(model, 0.1f, 0.65f, 6, 3, config);
+      InferenceEngine::PrintReport(variant.Replay(recordings));
+    }
+  }
 
   CompGuiX gui(display);
   gui.RunUnitTest();
@@ -69,9 +123,13 @@ int main() {
   SandGrid grid;
   grid.RunUnitTest();
 
+  SandBitboard<> bitboard;
+  bitboard.RunUnitTest();
+
   /* Main loop */
   FluxSand fluxsand(&pwm_buzzer, &gpio_user_button_1, &gpio_user_button_2, &gui,
-                    &bmp280, &aht20, &ads1115, &ahrs, &inference_engine);
+                    &bmp280, &aht20, &ads1115, &ahrs, &inference_engine,
+                    &mpu9250);
 
   fluxsand.RunUnitTest();
 